@@ -30,8 +30,8 @@ class Sys_abi
         auto       &p0() const { return s.gpr[0]; }
         auto       &p1() const { return s.gpr[1]; }
         auto       &p2() const { return s.gpr[2]; }
-        auto const &p3() const { return s.gpr[3]; }
-        auto const &p4() const { return s.gpr[4]; }
+        auto       &p3() const { return s.gpr[3]; }
+        auto       &p4() const { return s.gpr[4]; }
 
         ALWAYS_INLINE uint8_t flags() const { return p0() >> 4 & BIT_RANGE (3, 0); }
 };
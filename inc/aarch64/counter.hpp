@@ -33,6 +33,9 @@ class Counter final
         static Counter loc[Intid::NUM_PPI]  CPULOCAL;
         static Counter schedule             CPULOCAL;
         static Counter helping              CPULOCAL;
+        static Counter remote               CPULOCAL;
+        static Counter slab_reuse           CPULOCAL;   // Slabs reused instead of allocated
+        static Counter slab_reclaim         CPULOCAL;   // Slabs reclaimed under memory pressure
 
         ALWAYS_INLINE
         inline void inc()
@@ -297,9 +297,34 @@ class Cpu final
         ALWAYS_INLINE
         static inline auto remote_mpidr (unsigned cpu) { return *Kmem::loc_to_glob (&mpidr, cpu); }
 
+        /*
+         * Determine the topological distance of another core
+         *
+         * With multithreading (MPIDR.MT), Aff0 identifies the threads of a core.
+         *
+         * @param c     Core
+         * @return      0 (SMT sibling), 1 (same cluster), 2 (otherwise)
+         */
+        static unsigned distance (cpu_t c)
+        {
+            auto const s { mpidr & BIT (24) ? 8 : 0 };
+            auto const a { affinity_bits (mpidr) >> s }, b { affinity_bits (remote_mpidr (c)) >> s };
+
+            return a == b ? 0 : a >> 8 == b >> 8 ? 1 : 2;
+        }
+
         ALWAYS_INLINE
         static inline auto remote_ptab (unsigned cpu) { return *Kmem::loc_to_glob (&ptab, cpu); }
 
+        /*
+         * Determine if all cores are online
+         *
+         * If so, the CPU-local area of the current core is accessible, which
+         * is not the case during early boot and during resume from sleep.
+         */
+        ALWAYS_INLINE
+        static inline bool all_online() { auto const n { online.load() }; return n && n == count; }
+
         ALWAYS_INLINE
         static inline void preemption_disable() { asm volatile ("msr daifset, #0xf" : : : "memory"); }
 
@@ -71,8 +71,9 @@ struct alignas (16) Cpu_regs final
     Space_obj *   const obj;
     Space_hst *   const hst;
     Space_gst *         gst     { nullptr };
+    Space_pio *   const pio     { nullptr };
     Hazard              hazard  { 0 };
 
-    inline Cpu_regs (Space_obj *o, Space_hst *h, Space_pio * = nullptr) : vmcb (nullptr), obj (o), hst (h) {}
+    inline Cpu_regs (Space_obj *o, Space_hst *h, Space_pio *p = nullptr) : vmcb (nullptr), obj (o), hst (h), pio (p) {}
     inline Cpu_regs (Space_obj *o, Space_hst *h, Vmcb *v) : vmcb (v), obj (o), hst (h), hazard (Hazard::ILLEGAL) {}
 };
@@ -216,6 +216,8 @@ class Smmu final : public List<Smmu>
 
         bool configure (Space_dma *, uintptr_t);
 
+        void detach (Space_dma const *);
+
         // FIXME: Reports first SMMU only
         static inline uint8_t avail_smg() { return list ? list->num_smg : 0; }
         static inline uint8_t avail_ctx() { return list ? list->num_ctx : 0; }
@@ -232,6 +234,12 @@ class Smmu final : public List<Smmu>
                 smmu->tlb_invalidate (s);
         }
 
+        static inline void detach_all (Space_dma const *dma)
+        {
+            for (auto smmu { list }; smmu; smmu = smmu->next)
+                smmu->detach (dma);
+        }
+
         static inline Smmu *lookup (Hpt::OAddr p)
         {
             for (auto smmu { list }; smmu; smmu = smmu->next)
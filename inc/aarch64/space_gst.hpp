@@ -49,9 +49,17 @@ class Space_gst final : public Space_mem<Space_gst>
             return nullptr;
         }
 
-        inline void destroy (Slab_cache &cache) { operator delete (this, cache); }
+        inline void destroy (Slab_cache &cache)
+        {
+            // VMIDs are reused, so stale translations must be gone before the page tables
+            sync();
+
+            nptp.root_fini();
+
+            operator delete (this, cache);
+        }
 
-        inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return nptp.update (v, p, o, pm, ma); }
+        inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return nptp.update (v, p, o, pm, ma, node); }
 
         inline void sync() { nptp.invalidate (vmid); }
 
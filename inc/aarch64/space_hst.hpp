@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "buddy.hpp"
 #include "ptab_npt.hpp"
 #include "space_mem.hpp"
 
@@ -31,6 +32,8 @@ class Space_hst final : public Space_mem<Space_hst>
         inline Space_hst (Pd *p) : Space_mem (Kobject::Subtype::HST, p) {}
 
     public:
+        Buddy::Retainlist retained;                     // Unmapped UTCBs
+
         static Space_hst nova;
 
         static inline auto selectors() { return BIT64 (Npt::ibits - PAGE_BITS); }
@@ -53,15 +56,24 @@ class Space_hst final : public Space_mem<Space_hst>
             return nullptr;
         }
 
-        inline void destroy (Slab_cache &cache) { operator delete (this, cache); }
+        inline void destroy (Slab_cache &cache)
+        {
+            nptp.root_fini();
+            retained.free();
+
+            operator delete (this, cache);
+        }
 
         inline auto lookup (uint64_t v, uint64_t &p, unsigned &o, Memattr &ma) const { return nptp.lookup (v, p, o, ma); }
 
-        inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return nptp.update (v, p, o, pm, ma); }
+        inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return nptp.update (v, p, o, pm, ma, node); }
 
-        inline void sync() { nptp.invalidate (vmid); }
+        inline void sync() { retained.wait(); nptp.invalidate (vmid); }
 
         inline void make_current() { nptp.make_current (vmid); }
 
+        // All cores use the same page table
+        inline bool init (unsigned) { return true; }
+
         static void user_access (uint64_t addr, size_t size, bool a) { Space_mem::user_access (nova, addr, size, a, Memattr::dev()); }
 };
@@ -23,6 +23,7 @@
 
 #include "arch.hpp"
 #include "memory.hpp"
+#include "numa.hpp"
 #include "queue.hpp"
 #include "spinlock.hpp"
 
@@ -44,8 +45,9 @@ class Buddy final
                     FREE,
                 };
 
-                order_t ord { 0 };
-                Tag     tag { Tag::USED };
+                order_t         ord  { 0 };
+                Tag             tag  { Tag::USED };
+                Numa::node_t    node { 0 };
         };
 
         class Freelist final
@@ -69,14 +71,40 @@ class Buddy final
                 auto dequeue()          { return list.dequeue_head(); }
         };
 
+        class Magazine final
+        {
+            private:
+                Queue<Block> list;
+                unsigned     count { 0 };
+
+            public:
+                static constexpr unsigned batch { 16 };         // Blocks moved per refill/drain
+                static constexpr unsigned limit { 2 * batch };  // Blocks cached at most
+
+                bool empty() const { return !count; }
+                bool full()  const { return count >= limit; }
+
+                void enqueue (Block *b) { list.enqueue_head (b); count++; }
+                auto dequeue()          { auto const b { list.dequeue_head() }; count -= !!b; return b; }
+        };
+
+        // Orders below mag_orders are cached in per-core magazines
+        static constexpr order_t mag_orders { 2 };
+
+        // Free pages below which the allocator is considered under memory pressure
+        static constexpr size_t watermark { 1024 };
+
         static inline Spinlock      lock;       // Allocator Spinlock
         static inline index_t       min_idx;    // Minimum Block Index
         static inline index_t       max_idx;    // Maximum Block Index
         static inline uintptr_t     mem_base;   // Base of Memory Pool
+        static inline size_t        pages;      // Free Pages in the Freelists
         static inline Block *       blk_base;   // Base of Block Array
-        static inline Freelist      freelist;   // Block Freelist
+        static inline Freelist      freelist[Numa::nodes];  // Block Freelists (per Node)
 
         static Waitlist waitlist    CPULOCAL;   // Block Waitlist (per Core)
+        static Magazine magazine[mag_orders] CPULOCAL;  // Block Magazines (per Core)
+        static Magazine zeroed                CPULOCAL;  // Pre-Zeroed Order-0 Blocks (per Core)
 
         static bool valid (index_t x) { return x >= min_idx && x < max_idx; }
 
@@ -86,8 +114,14 @@ class Buddy final
         static auto index_to_page (index_t x)   { return mem_base + x * PAGE_SIZE; }
         static auto page_to_index (uintptr_t x) { return static_cast<index_t>((x - mem_base) / PAGE_SIZE); }
 
+        static Block *dequeue (Freelist &, order_t);
+        static Block *dequeue (order_t, Numa::node_t);
+
         NONNULL static void coalesce (Block *);
 
+        static void refill (order_t);
+        static void drain (order_t, unsigned);
+
     public:
         enum class Fill
         {
@@ -96,12 +130,41 @@ class Buddy final
             BITS1,
         };
 
+        /*
+         * Blocks that may only be freed after the next TLB synchronization
+         * of the address space that maps them
+         */
+        class Retainlist final
+        {
+            private:
+                Queue<Block> list;
+                Spinlock     lock;
+
+            public:
+                void enqueue (void *);
+                void wait();
+                void free();
+                bool empty();
+        };
+
         static void init();
+        static void partition();
 
-        [[nodiscard]] static void *alloc (order_t, Fill = Fill::NONE);
+        [[nodiscard]] static void *alloc (order_t, Fill = Fill::NONE, Numa::node_t = Numa::local);
 
         static void free (void *);
         static void wait (void *);
 
-        static void free_wait() { for (Block *b; (b = waitlist.dequeue()); coalesce (b)); }
+        static void free_wait();
+
+        static void flush();
+
+        static bool prezero();
+
+        /*
+         * Determine if the allocator is under memory pressure
+         *
+         * @return          True if the freelists are below the watermark
+         */
+        static bool low() { return pages < watermark; }
 };
@@ -130,12 +130,18 @@ class Capability final
         ALWAYS_INLINE
         inline auto validate (Perm_sc p) const { return validate (Kobject::Type::SC, std::to_underlying (p)); }
 
+        ALWAYS_INLINE
+        inline auto validate (Perm_sc p, Kobject::Subtype s) const { return validate (Kobject::Type::SC, s, std::to_underlying (p)); }
+
         ALWAYS_INLINE
         inline auto validate (Perm_pt p) const { return validate (Kobject::Type::PT, std::to_underlying (p)); }
 
         ALWAYS_INLINE
         inline auto validate (Perm_sm p) const { return validate (Kobject::Type::SM, std::to_underlying (p)); }
 
+        ALWAYS_INLINE
+        inline auto validate (Perm_sm p, Kobject::Subtype s) const { return validate (Kobject::Type::SM, s, std::to_underlying (p)); }
+
         ALWAYS_INLINE
         static inline bool validate_take_grant (Capability const &cst, Capability const &cdt, Kobject::Subtype &st, Kobject::Subtype &dt)
         {
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "abi.hpp"
 #include "atomic.hpp"
 #include "kmem.hpp"
 #include "kobject.hpp"
@@ -33,11 +34,13 @@
 #include "timeout_hypercall.hpp"
 
 class Fpu;
+class Pt;
 class Utcb;
 
 class Ec : public Kobject, private Queue<Sc>, public Queue<Ec>::Element
 {
     friend class Ec_arch;
+    friend class Sm;
     friend class Tlb;
 
     private:
@@ -45,18 +48,79 @@ class Ec : public Kobject, private Queue<Sc>, public Queue<Ec>::Element
 
         Cpu_regs            regs;
         unsigned long const evt;
-        cpu_t         const cpu;
+        Atomic<cpu_t>       cpu;                        // Changes only when the EC migrates (see migrate)
         Fpu *         const fpu;
         void *        const kpage;
+        uintptr_t     const kva;                        // User address of the UTCB or vAPIC page (0 if none)
         Ec *                callee      { nullptr };
         Ec *                caller      { nullptr };
+        Ec *                client      { nullptr };    // Proxy EC: Remote caller on whose behalf it calls
+        Sc *                carrier     { nullptr };    // Proxy EC: SC of the remote call
+        uint64_t            issued      { 0 };          // Proxy EC: Time at which the remote call was issued
         Atomic<cont_t>      cont        { nullptr };
+        uint16_t            mc_idx      { 0 };          // Multicall: Current entry
+        uint16_t            mc_cnt      { 0 };          // Multicall: Number of entries (0 if inactive)
+        uint16_t            scs         { 0 };          // Number of SCs bound to this EC
+        bool                retired     { false };      // Nothing can reach the EC anymore (see collect)
         Timeout_hypercall   timeout     { this };
         Spinlock            lock;
 
+        // Event portal cache, valid for one generation of the OBJ space
+        struct Evt_entry
+        {
+            unsigned long   ep { 0 };
+            Pt *            pt { nullptr };
+        };
+
+        static constexpr unsigned evt_entries { 32 };
+
+        uint64_t            evt_gen     { 0 };
+        Evt_entry           evt_cache[evt_entries];
+
+        // Wait-for-any: linkage of the EC into the queue of each SM it waits on
+        class Waiter final : public Queue<Waiter>::Element
+        {
+            public:
+                Ec *    ec { nullptr };
+                Sm *    sm { nullptr };
+        };
+
+        static constexpr unsigned waiters { 8 };
+        static constexpr uint8_t  hit_timeout { waiters + 1 };
+
+        Waiter              wait[waiters];
+        uint8_t             wait_cnt    { 0 };          // Wait-for-any: Number of SMs
+        Atomic<uint8_t>     wait_hit    { 0 };          // Wait-for-any: Index + 1 of the SM that fired (0 if none)
+        Atomic<Sm *>        blocker     { nullptr };    // Down: SM on whose queue the EC blocks (see Sm::cancel)
+
+        /*
+         * Record the event that wakes an EC waiting for any of several SMs
+         *
+         * @param h     Index + 1 of the SM that fired (or hit_timeout)
+         * @return      True if this event wakes the EC, false if another event already did
+         */
+        inline bool hit (uint8_t h)
+        {
+            uint8_t o { 0 };
+            return wait_hit.compare_exchange (o, h);
+        }
+
         static Atomic<Ec *> current asm ("current") CPULOCAL;
+        // Idle proxy ECs of a core, each with its SC blocked on it
+        class Proxies final
+        {
+            private:
+                Queue<Ec>   queue;
+                Spinlock    lock;
+
+            public:
+                void enqueue (Ec *);
+                Ec *dequeue (cpu_t);
+        };
+
         static Ec *         fpowner                 CPULOCAL;
         static unsigned     donations               CPULOCAL;
+        static Proxies      proxies                 CPULOCAL;
         static Slab_cache   cache;
 
         ALWAYS_INLINE inline auto &cpu_regs() { return regs; }
@@ -96,16 +160,28 @@ class Ec : public Kobject, private Queue<Sc>, public Queue<Ec>::Element
         ALWAYS_INLINE inline Space_obj *get_obj() const { return regs.obj; }
         ALWAYS_INLINE inline Space_hst *get_hst() const { return regs.hst; }
         ALWAYS_INLINE inline Space_gst *get_gst() const { return regs.gst; }
+        ALWAYS_INLINE inline Space_pio *get_pio() const { return regs.pio; }
 
         ALWAYS_INLINE
         inline void rendezvous (Ec *, cont_t, cont_t, uintptr_t, uintptr_t, uintptr_t);
 
+        void transfer (Ec *, Mtd_user) const;
+
+        Pt *event_portal (unsigned long);
+
         [[noreturn]] HOT
         void reply (cont_t = nullptr);
 
         [[noreturn]]
         void kill (char const *);
 
+        Ec *get_proxy (Status &, cpu_t);
+
+        [[noreturn]]
+        void call_remote (cpu_t);
+
+        static bool acquire (Space_obj *, Space_hst *, Space_pio * = nullptr);
+
         [[noreturn]]
         static void dead (Ec *self) { self->kill ("IPC Abort"); }
 
@@ -119,7 +195,17 @@ class Ec : public Kobject, private Queue<Sc>, public Queue<Ec>::Element
         static void recv_kern (Ec *);
 
         [[noreturn]] HOT
-        static void recv_user (Ec *);
+        static void recv_remote (Ec *);
+
+        [[noreturn]]
+        static void serve (Ec *);
+
+        template <cont_t>
+        [[noreturn]]
+        static void finish_remote (Ec *);
+
+        [[noreturn]]
+        static void recycle (Ec *);
 
         template <cont_t>
         [[noreturn]]
@@ -170,18 +256,24 @@ class Ec : public Kobject, private Queue<Sc>, public Queue<Ec>::Element
         [[noreturn]]
         static void sys_assign_dev (Ec *);
 
+        [[noreturn]]
+        static void sys_multicall (Ec *);
+
+        [[noreturn]]
+        static void multicall (Ec *);
+
         [[noreturn]]
         void sys_finish_status (Status);
 
         // Constructor: Kernel Thread
-        Ec (Space_hst *h, cpu_t c, cont_t x) : Kobject (Kobject::Type::EC, Kobject::Subtype::EC_GLOBAL), regs (nullptr, h), evt (0), cpu (c), fpu (nullptr), kpage (nullptr), cont (x) {}
+        Ec (Space_hst *h, cpu_t c, cont_t x) : Kobject (Kobject::Type::EC, Kobject::Subtype::EC_GLOBAL), regs (nullptr, h), evt (0), cpu (c), fpu (nullptr), kpage (nullptr), kva (0), cont (x) {}
 
         // Constructor: HST EC
-        Ec (bool t, Fpu *f, Space_obj *o, Space_hst *h, Space_pio *p, void *k, cpu_t c, unsigned long e, cont_t x) : Kobject (Kobject::Type::EC, t ? Kobject::Subtype::EC_GLOBAL : Kobject::Subtype::EC_LOCAL), regs (o, h, p), evt (e), cpu (c), fpu (f), kpage (k), cont (x) {}
+        Ec (bool t, Fpu *f, Space_obj *o, Space_hst *h, Space_pio *p, void *k, uintptr_t u, cpu_t c, unsigned long e, cont_t x) : Kobject (Kobject::Type::EC, t ? Kobject::Subtype::EC_GLOBAL : Kobject::Subtype::EC_LOCAL), regs (o, h, p), evt (e), cpu (c), fpu (f), kpage (k), kva (u), cont (x) {}
 
         // Constructor: GST EC
         template <typename T>
-        Ec (bool t, Fpu *f, Space_obj *o, Space_hst *h, T *v, void *k, cpu_t c, unsigned long e, cont_t x) : Kobject (Kobject::Type::EC, t ? Kobject::Subtype::EC_VCPU_OFFS : Kobject::Subtype::EC_VCPU_REAL), regs (o, h, v), evt (e), cpu (c), fpu (f), kpage (k), cont (x) {}
+        Ec (bool t, Fpu *f, Space_obj *o, Space_hst *h, T *v, void *k, uintptr_t u, cpu_t c, unsigned long e, cont_t x) : Kobject (Kobject::Type::EC, t ? Kobject::Subtype::EC_VCPU_OFFS : Kobject::Subtype::EC_VCPU_REAL), regs (o, h, v), evt (e), cpu (c), fpu (f), kpage (k), kva (u), cont (x) {}
 
     public:
         // Factory: Kernel Thread
@@ -193,13 +285,45 @@ class Ec : public Kobject, private Queue<Sc>, public Queue<Ec>::Element
         // Factory: GST EC
         [[nodiscard]] static Ec *create_gst (Status &s, Pd *, bool, bool, cpu_t, unsigned long, uintptr_t, uintptr_t);
 
-        inline void destroy() { operator delete (this, cache); }
+        void destroy();
+
+        bool collect();
+
+        void unload_vcpu();
+
+        void destroy_vcpu();
 
         static void create_idle();
+        static void create_proxy();
         static void create_root();
 
         static bool switch_fpu (Ec *);
 
+        cpu_t get_cpu() const { return cpu; }
+
+        bool migrate (cpu_t);
+
+        /*
+         * Account for an SC that is bound to this EC
+         *
+         * @return      Core of the EC, on which the SC runs
+         */
+        cpu_t bind_sc()
+        {
+            Lock_guard <Spinlock> guard { lock };
+
+            scs++;
+
+            return cpu;
+        }
+
+        void unbind_sc()
+        {
+            Lock_guard <Spinlock> guard { lock };
+
+            scs--;
+        }
+
         ALWAYS_INLINE
         static inline Ec *remote_current (unsigned cpu)
         {
@@ -250,8 +374,15 @@ class Ec : public Kobject, private Queue<Sc>, public Queue<Ec>::Element
                 if (!blocked())
                     return false;
 
+                auto const sc { Scheduler::get_current() };
+
+                // A retired SC can no longer be found by Sc::collect, so defer it instead
+                if (EXPECT_FALSE (sc->retired))
+                    sc->defer();
+
                 // Otherwise D will later unblock the SC
-                enqueue_tail (Scheduler::get_current());
+                else
+                    enqueue_tail (sc);
             }
 
             return true;
@@ -265,6 +396,38 @@ class Ec : public Kobject, private Queue<Sc>, public Queue<Ec>::Element
             for (Sc *sc; (sc = dequeue_head()); Scheduler::unblock (sc)) ;
         }
 
+        /*
+         * Remove a retired SC that is blocked on this EC
+         *
+         * @param sc    Retired SC
+         * @return      True if the SC was blocked on this EC, false otherwise
+         */
+        bool remove_sc (Sc *sc)
+        {
+            Lock_guard <Spinlock> guard { lock };
+
+            Queue<Sc> q;
+            bool found { false };
+
+            for (Sc *s; (s = dequeue_head()); )
+                if (s == sc)
+                    found = true;
+                else
+                    q.enqueue_tail (s);
+
+            for (Sc *s; (s = q.dequeue_head()); enqueue_tail (s)) ;
+
+            return found;
+        }
+
+        /*
+         * Set the value that a blocked hypercall returns in p1 when the EC resumes
+         *
+         * @param v     Value
+         */
+        ALWAYS_INLINE
+        inline void set_result (uint64_t v) { Sys_abi (sys_regs()).p1() = v; }
+
         ALWAYS_INLINE
         inline void set_timeout (uint64_t t, Sm *s)
         {
@@ -22,13 +22,18 @@
 #pragma once
 
 #include "macros.hpp"
+#include "rcu.hpp"
+#include "refptr.hpp"
 #include "slab.hpp"
 #include "types.hpp"
 
-class Kobject
+class Kobject : public Refcount, private Rcu_elem
 {
     friend class Capability;
 
+    private:
+        static void free (Rcu_elem *);
+
     public:
         static constexpr auto alignment { BIT (5) };
 
@@ -57,13 +62,26 @@ class Kobject
             DMA             = 4,
             PIO             = 5,
             MSR             = 6,
+
+            SC_SCHED        = 0,
+            SC_GROUP        = 1,
+
+            SM_SEMAPHORE    = 0,
+            SM_NOTIFICATION = 1,
+            SM_INHERITANCE  = 2,
         };
 
     protected:
         Type    const   type;
         Subtype const   subtype;
 
-        inline explicit Kobject (Type t, Subtype s = Subtype::NONE) : type (t), subtype (s) {}
+        inline explicit Kobject (Type t, Subtype s = Subtype::NONE) : Rcu_elem (free), type (t), subtype (s) {}
+
+        // Destroy the object after all cores have passed through a quiescent state
+        inline void defer() { Rcu::call (this); }
+
+        // Destroy the object on the specified core after all cores have passed through a quiescent state
+        inline void defer (cpu_t c) { Rcu::call (this, c); }
 
         [[nodiscard]] static inline void *operator new (size_t, Slab_cache &cache) noexcept
         {
@@ -75,4 +93,7 @@ class Kobject
             if (EXPECT_TRUE (ptr))
                 cache.free (ptr);
         }
+
+    public:
+        void release();
 };
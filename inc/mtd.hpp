@@ -41,5 +41,7 @@ class Mtd_user final : public Mtd
 
         inline auto count() const { return mtd % items + 1; }
 
+        inline auto typed() const { return mtd >> 16 & BIT_RANGE (7, 0); }
+
         inline explicit Mtd_user (uint32_t v) : Mtd (v) {}
 };
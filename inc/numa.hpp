@@ -0,0 +1,69 @@
+/*
+ * Non-Uniform Memory Access (NUMA)
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "compiler.hpp"
+#include "kmem.hpp"
+#include "types.hpp"
+
+class Numa final
+{
+    public:
+        using node_t = uint8_t;
+
+        static constexpr node_t nodes { 8 };            // Maximum number of nodes
+        static constexpr node_t local { nodes };        // Preference: node of the current core
+
+    private:
+        static constexpr unsigned max_mem { 32 };       // Maximum number of memory ranges
+        static constexpr unsigned max_cpu { 256 };      // Maximum number of processors
+
+        struct Mem
+        {
+            uint64_t    base, size;
+            node_t      node;
+        };
+
+        struct Proc
+        {
+            uint32_t    topology;
+            node_t      node;
+        };
+
+        static inline uint32_t  pxm[nodes];             // Proximity Domain of each Node
+        static inline Mem       mem[max_mem];           // Memory Affinity
+        static inline Proc      cpu[max_cpu];           // Processor Affinity
+        static inline unsigned  mem_count { 0 };
+        static inline unsigned  cpu_count { 0 };
+
+        static node_t pxm_to_node (uint32_t);
+
+    public:
+        static inline node_t    count { 1 };            // Number of nodes
+        static inline node_t    boot  { 0 };            // Node of the core that is booting
+
+        static node_t node      CPULOCAL;               // Node of the current core
+
+        static void add_mem (uint64_t, uint64_t, uint32_t);
+        static void add_cpu (uint32_t, uint32_t);
+
+        static node_t node_by_phys (uint64_t);
+        static node_t node_by_topology (uint32_t);
+
+        static auto node_by_cpu (cpu_t c) { return *Kmem::loc_to_glob (&node, c); }
+};
@@ -26,6 +26,7 @@
 #include "status.hpp"
 #include "std.hpp"
 
+class Space;
 class Space_dma;
 class Space_gst;
 class Space_hst;
@@ -36,6 +37,7 @@ class Space_pio;
 class Ec;
 class Pt;
 class Sc;
+class Scg;
 class Sm;
 
 class Pd final : public Kobject
@@ -77,6 +79,15 @@ class Pd final : public Kobject
 
         inline void destroy() { operator delete (this, cache); }
 
+        void destroy (Space_obj *);
+        void destroy (Space_hst *);
+        void destroy (Space_gst *);
+        void destroy (Space_dma *);
+        void destroy (Space_pio *);
+        void destroy (Space_msr *);
+
+        void unpublish (Space const *);
+
         inline Space_obj *get_obj() const { return space_obj; }
         inline Space_hst *get_hst() const { return space_hst; }
         inline Space_pio *get_pio() const { return space_pio; }
@@ -90,7 +101,8 @@ class Pd final : public Kobject
 
         static Pd *create_pd (Status &, Space_obj *, unsigned long, unsigned);
         static Ec *create_ec (Status &, Space_obj *, unsigned long, Pd *, cpu_t, uintptr_t, uintptr_t, uintptr_t, uint8_t);
-        static Sc *create_sc (Status &, Space_obj *, unsigned long, Ec *, cpu_t, uint16_t, uint8_t, uint16_t);
+        static Sc *create_sc (Status &, Space_obj *, unsigned long, Ec *, uint32_t, uint8_t, uint16_t, bool = false, uint32_t = 0, uint32_t = 0);
+        static Scg *create_scg (Status &, Space_obj *, unsigned long, Scg *, cpu_t, uint32_t, uint32_t);
         static Pt *create_pt (Status &, Space_obj *, unsigned long, Ec *, uintptr_t);
-        static Sm *create_sm (Status &, Space_obj *, unsigned long, uint64_t, unsigned = ~0U);
+        static Sm *create_sm (Status &, Space_obj *, unsigned long, uint64_t, unsigned = ~0U, Kobject::Subtype = Kobject::Subtype::SM_SEMAPHORE);
 };
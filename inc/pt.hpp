@@ -53,7 +53,7 @@ class Pt final : public Kobject
             return pt;
         }
 
-        inline void destroy() { operator delete (this, cache); }
+        void destroy();
 
         ALWAYS_INLINE
         inline uintptr_t get_id() const { return id; }
@@ -78,9 +78,12 @@ class Ptab
 
         Paging::Permissions lookup (IAddr, OAddr &, unsigned &, Memattr &) const;
 
-        Status update (IAddr, OAddr, unsigned, Paging::Permissions, Memattr);
+        Status update (IAddr, OAddr, unsigned, Paging::Permissions, Memattr, Numa::node_t = Numa::local);
 
-        [[nodiscard]] inline auto root_init (unsigned l = T::lev() - 1) { return walk (0, l, true); }
+        [[nodiscard]] inline auto root_init (unsigned l = T::lev() - 1, Numa::node_t n = Numa::local) { return walk (0, l, true, n); }
+
+        void root_fini();
+        void root_fini (IAddr, unsigned);
 
         ALWAYS_INLINE
         inline auto root_addr() const
@@ -99,7 +102,7 @@ class Ptab
 
         Ptab (Entry e) : entry (e) {}
 
-        [[nodiscard]] PTE *walk (IAddr, unsigned, bool);
+        [[nodiscard]] PTE *walk (IAddr, unsigned, bool, Numa::node_t = Numa::local);
 
     private:
         // Maximum leaf level: 3 (512GB), 2 (1GB), 1 (2MB), 0 (4KB)
@@ -116,10 +119,11 @@ class Ptab
         }
 
         void deallocate (unsigned);
+        void destroy (unsigned);
 
-        [[nodiscard]] static inline void *operator new (size_t, unsigned o) noexcept
+        [[nodiscard]] static inline void *operator new (size_t, unsigned o, Numa::node_t n) noexcept
         {
-            return Buddy::alloc (static_cast<uint8_t>(o));
+            return Buddy::alloc (static_cast<uint8_t>(o), Buddy::Fill::NONE, n);
         }
 
         NONNULL ALWAYS_INLINE
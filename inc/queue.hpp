@@ -29,6 +29,12 @@ template <typename T>
 class Queue
 {
     public:
+        /*
+         * Queue linkage
+         *
+         * Accesses are qualified, because queued objects may inherit other
+         * members of the same name (e.g., the RCU linkage of kernel objects).
+         */
         class Element
         {
             friend class Queue<T>;
@@ -70,13 +76,13 @@ class Queue
             assert (!e->queued());
 
             if (!head) {
-                head = e->prev = e->next = e;
+                head = e->Element::prev = e->Element::next = e;
                 return true;
             }
 
-            e->next = head;
-            e->prev = head->prev;
-            e->next->prev = e->prev->next = e;
+            e->Element::next = head;
+            e->Element::prev = head->prev;
+            e->Element::next->prev = e->Element::prev->next = e;
 
             if (h)
                 head = e;
@@ -90,6 +96,34 @@ class Queue
         ALWAYS_INLINE NONNULL
         inline auto enqueue_tail (T *e) { return enqueue (e, false); }
 
+        /*
+         * Enqueue element into this queue before the first element it precedes
+         *
+         * @param e     Element to enqueue
+         * @param f     Predicate that determines if its first argument precedes its second argument
+         * @return      True if the queue was empty, false otherwise
+         */
+        template <typename F>
+        ALWAYS_INLINE NONNULL
+        inline bool enqueue_sorted (T *e, F f)
+        {
+            if (!head || f (e, static_cast<T *>(head)))
+                return enqueue (e, true);
+
+            auto n { head->next };
+
+            while (n != head && !f (e, static_cast<T *>(n)))
+                n = n->next;
+
+            assert (!e->queued());
+
+            e->Element::next = n;
+            e->Element::prev = n->prev;
+            e->Element::next->prev = e->Element::prev->next = e;
+
+            return false;
+        }
+
         /*
          * Dequeue element from this queue
          *
@@ -100,17 +134,17 @@ class Queue
         {
             assert (e->queued());
 
-            if (e == e->next)
+            if (e == e->Element::next)
                 head = nullptr;
 
             else {
-                e->next->prev = e->prev;
-                e->prev->next = e->next;
+                e->Element::next->prev = e->Element::prev;
+                e->Element::prev->next = e->Element::next;
                 if (e == head)
-                    head = e->next;
+                    head = e->Element::next;
             }
 
-            e->next = e->prev = nullptr;
+            e->Element::next = e->Element::prev = nullptr;
         }
 
         /*
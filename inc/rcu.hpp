@@ -29,10 +29,10 @@ class Rcu_elem
 {
     public:
         Rcu_elem *next;
-        void (*func)(Rcu_elem *);
+        void (*callback)(Rcu_elem *);
 
         ALWAYS_INLINE
-        explicit Rcu_elem (void (*f)(Rcu_elem *)) : next (nullptr), func (f) {}
+        explicit Rcu_elem (void (*f)(Rcu_elem *)) : next (nullptr), callback (f) {}
 };
 
 class Rcu_list
@@ -76,6 +76,7 @@ class Rcu
         static Rcu_list     next    CPULOCAL;
         static Rcu_list     curr    CPULOCAL;
         static Rcu_list     done    CPULOCAL;
+        static Rcu_elem *   xfer    CPULOCAL;       // Elements handed over by other cores
 
         enum State
         {
@@ -96,6 +97,8 @@ class Rcu
         ALWAYS_INLINE
         static inline void call (Rcu_elem *e) { next.enqueue (e); }
 
+        static void call (Rcu_elem *, cpu_t);
+
         static void quiet();
         static void update();
 };
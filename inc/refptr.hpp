@@ -65,7 +65,7 @@ class Refptr
         ALWAYS_INLINE
         inline ~Refptr()
         {
-            if (ptr && ptr->del_ref())
-                delete ptr;
+            if (ptr)
+                ptr->release();
         }
 };
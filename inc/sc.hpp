@@ -27,31 +27,79 @@
 #include "kobject.hpp"
 #include "queue.hpp"
 #include "status.hpp"
+#include "timeout_replenish.hpp"
 
 class Ec;
+class Scg;
 
 class Sc final : public Kobject, public Queue<Sc>::Element
 {
+    friend class Ec;
     friend class Scheduler;
+    friend class Timeout_replenish;
 
     private:
         Ec *     const          ec                  { nullptr };
-        uint64_t const          budget              { 0 };
-        cpu_t    const          cpu                 { 0 };
-        uint16_t const          cos                 { 0 };
-        uint8_t  const          prio                { 0 };
+        uint64_t                budget              { 0 };          // Changes only for the SC of a proxy EC (see adopt)
+        cpu_t                   cpu                 { 0 };
+        uint16_t                cos                 { 0 };
+        uint8_t                 prio                { 0 };
+        bool     const          migratable          { false };
+        uint64_t                period              { 0 };          // EDF: Replenishment period (0 for round-robin SCs)
+        uint64_t                relative            { 0 };          // EDF: Relative deadline
+        uint64_t                deadline            { 0 };          // EDF: Absolute deadline (~0 for round-robin SCs)
         Atomic<uint64_t>        used                { 0 };
         uint64_t                left                { 0 };
         uint64_t                last                { 0 };
+        Atomic<bool>            retired             { false };
+        Atomic<Scg *>           group               { nullptr };    // Quota group (or nullptr)
+        Atomic<Sc *>            link                { nullptr };    // Release queue linkage
+        Timeout_replenish       replenish           { this };
 
         static Slab_cache       cache;
 
-        Sc (cpu_t, Ec *, uint16_t, uint8_t, uint16_t);
+        Sc (Ec *, uint32_t, uint8_t, uint16_t, bool, uint32_t, uint32_t);
+        Sc (Ec *, Sc const *);
+
+        // Determine if this SC precedes another SC of the same priority
+        inline bool precedes (Sc const *sc) const { return deadline < sc->deadline; }
+
+        /*
+         * Adopt the scheduling parameters of another SC
+         *
+         * The SC must be blocked on its EC. The scheduler of its core
+         * reads only the budget accounting of a blocked SC, which this
+         * leaves alone.
+         *
+         * @param sc    SC whose scheduling parameters are adopted
+         */
+        void adopt (Sc const *sc)
+        {
+            budget   = sc->budget;
+            cos      = sc->cos;
+            prio     = sc->prio;
+            period   = sc->period;
+            relative = sc->relative;
+            deadline = period ? 0 : ~0ULL;
+        }
 
     public:
-        [[nodiscard]] static Sc *create (Status &s, cpu_t n, Ec *e, uint16_t b, uint8_t p, uint16_t c)
+        /*
+         * Create an SC
+         *
+         * An SC with a period is an EDF SC. It receives its budget once per
+         * period and is ordered by its deadline among SCs of its priority.
+         *
+         * @param b     Budget (us)
+         * @param p     Priority
+         * @param c     Class of Service
+         * @param m     Migratable
+         * @param t     EDF: Period (us) or 0
+         * @param d     EDF: Relative deadline (us)
+         */
+        [[nodiscard]] static Sc *create (Status &s, Ec *e, uint32_t b, uint8_t p, uint16_t c, bool m = false, uint32_t t = 0, uint32_t d = 0)
         {
-            auto const sc { new (cache) Sc (n, e, b, p, c) };
+            auto const sc { new (cache) Sc (e, b, p, c, m, t, d) };
 
             if (EXPECT_FALSE (!sc))
                 s = Status::MEM_OBJ;
@@ -59,7 +107,29 @@ class Sc final : public Kobject, public Queue<Sc>::Element
             return sc;
         }
 
-        void destroy() { operator delete (this, cache); }
+        /*
+         * Create an SC with the scheduling parameters of another SC
+         *
+         * The new SC has the budget, priority, class of service, and EDF
+         * parameters of the other SC, but does not migrate or join a group.
+         *
+         * @param sc    SC whose scheduling parameters are used
+         */
+        [[nodiscard]] static Sc *create (Status &s, Ec *e, Sc const *sc)
+        {
+            auto const n { new (cache) Sc (e, sc) };
+
+            if (EXPECT_FALSE (!n))
+                s = Status::MEM_OBJ;
+
+            return n;
+        }
+
+        void destroy();
+
+        void collect();
+
+        bool join (Scg *);
 
         auto get_ec() const { return ec; }
 
@@ -73,6 +143,7 @@ class Scheduler final
 
         static void unblock (Sc *);
         static void requeue();
+        static void steal();
 
         static auto get_current() { return current; }
 
@@ -85,27 +156,42 @@ class Scheduler final
         class Ready final
         {
             private:
-                Queue<Sc>   queue[priorities];
-                unsigned    prio_top { 0 };
+                static constexpr auto bpw { 8 * sizeof (unsigned long) };
+
+                static_assert (priorities % bpw == 0 && priorities / bpw <= bpw);
+
+                Queue<Sc>       queue[priorities];
+                unsigned long   prio_map[priorities / bpw] { 0 };  // Bitmap of non-empty priorities
+                unsigned long   prio_sum { 0 };                     // Bitmap of non-empty prio_map words
+                unsigned        prio_top { 0 };
+                Atomic<unsigned> movable { 0 };                     // Number of queued migratable SCs
+
+                void clear (unsigned);
 
             public:
                 void enqueue (Sc *, uint64_t);
                 auto dequeue (uint64_t);
+
+                Sc *migrate (cpu_t);
+
+                bool has_movable() const { return movable; }
         };
 
-        // Release queue
+        // Release queue: Lock-free list with multiple producers (any core) and a single consumer (the owning core)
         class Release final
         {
             private:
-                Queue<Sc>   queue;
-                Spinlock    lock;
+                Atomic<Sc *>    head    { nullptr };
 
             public:
                 void enqueue (Sc *);
-                auto dequeue();
+                Sc *dequeue();
         };
 
         static Ready        ready       CPULOCAL;
         static Release      release     CPULOCAL;
         static Sc *         current     CPULOCAL;
+        static Atomic<unsigned> thief   CPULOCAL;       // Idle core (+1) that requests an SC from this core
+        static Atomic<unsigned> misses  CPULOCAL;       // Requests of this core that no SC has answered yet
+        static uint64_t     retry       CPULOCAL;       // Time before which this core does not request an SC again
 };
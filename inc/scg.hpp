@@ -0,0 +1,91 @@
+/*
+ * Scheduling Context Group (SCG)
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "compiler.hpp"
+#include "kobject.hpp"
+#include "queue.hpp"
+#include "spinlock.hpp"
+#include "status.hpp"
+#include "timeout_quota.hpp"
+
+class Sc;
+
+class Scg final : public Kobject
+{
+    friend class Timeout_quota;
+
+    private:
+        Scg *    const          parent              { nullptr };    // Global group that this group draws from (or nullptr)
+        uint64_t const          budget              { 0 };          // Quota per period
+        uint64_t const          period              { 0 };
+        cpu_t    const          cpu                 { 0 };          // Core of the member SCs (global for a global group)
+        uint64_t                left                { 0 };          // Quota left in the current period
+        uint64_t                next                { 0 };          // End of the current period
+        Queue<Sc>               throttled;                          // Member SCs waiting for the next period
+        Timeout_quota           timeout             { this };
+        Spinlock                lock;                               // Only contended for a global group
+
+        static Slab_cache       cache;
+
+        Scg (Scg *, cpu_t, uint32_t, uint32_t);
+
+        // Replenish the quota at the end of the period, with the lock held
+        void refresh (uint64_t t)
+        {
+            if (t >= next) {
+                left = budget;
+                next = t + period;
+            }
+        }
+
+        uint64_t remaining (uint64_t, uint64_t &);
+
+    public:
+        static constexpr cpu_t global { static_cast<cpu_t>(~0U) };
+
+        /*
+         * Create an SC group
+         *
+         * All member SCs of a group share its quota, which is replenished
+         * once per period. A group on a core can additionally draw from a
+         * global group, which caps the quota of its members across cores.
+         *
+         * @param g     Global parent group (or nullptr)
+         * @param c     Core (or global)
+         * @param b     Quota per period (us)
+         * @param t     Period (us)
+         */
+        [[nodiscard]] static Scg *create (Status &s, Scg *g, cpu_t c, uint32_t b, uint32_t t)
+        {
+            auto const scg { new (cache) Scg (g, c, b, t) };
+
+            if (EXPECT_FALSE (!scg))
+                s = Status::MEM_OBJ;
+
+            return scg;
+        }
+
+        void destroy();
+
+        void charge (uint64_t, uint64_t);
+
+        uint64_t admit (Sc *, uint64_t);
+
+        auto get_cpu() const { return cpu; }
+};
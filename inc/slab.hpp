@@ -29,16 +29,74 @@ class Slab_cache final
     private:
         struct Slab;
 
+        class Magazine final
+        {
+            private:
+                struct Buffer { Buffer *next; } *head { nullptr };
+                unsigned count { 0 };
+
+            public:
+                static constexpr unsigned batch { 8 };          // Buffers moved per refill/drain
+                static constexpr unsigned limit { 2 * batch };  // Buffers cached at most
+
+                bool empty() const { return !count; }
+                bool full()  const { return count >= limit; }
+
+                void enqueue (void *p)
+                {
+                    auto const b { static_cast<Buffer *>(p) };
+                    b->next = head;
+                    head = b;
+                    count++;
+                }
+
+                void *dequeue()
+                {
+                    auto const b { head };
+                    if (EXPECT_TRUE (b)) {
+                        head = b->next;
+                        count--;
+                    }
+                    return b;
+                }
+        };
+
+        // Number of slab caches that can have per-core magazines
+        static constexpr unsigned magazines { 8 };
+
+        static inline unsigned mag_next { 0 };
+
+        // Number of empty slabs retained by slab caches with static storage duration
+        static constexpr unsigned retain { 2 };
+
+        static inline Slab_cache *list { nullptr };     // Slab Caches that retain empty slabs
+
         uint16_t const  bsz;                    // Buffer size
         uint16_t const  bps;                    // Buffers per Slab
+        unsigned const  mag;                    // Magazine index (or magazines if none)
+        unsigned const  rmax;                   // Maximum Retained Empty Slabs
         Slab *          curr    { nullptr };    // Current (Partial) Slab
         Slab *          head    { nullptr };    // Head of Slab List
+        Slab *          idle    { nullptr };    // Head of Retained Empty Slab List
+        Slab_cache *    next    { nullptr };    // Next Slab Cache that retains empty slabs
+        unsigned        icnt    { 0 };          // Retained Empty Slab Count
         Spinlock        lock;                   // Allocator Spinlock
 
+        static Magazine magazine[magazines] CPULOCAL;   // Buffer Magazines (per Core)
+
+        [[nodiscard]] void *alloc_slab();
+
+        void free_slab (void *);
+
+        void refill (Magazine &);
+        void drain (Magazine &, unsigned);
+
     public:
         [[nodiscard]] void *alloc();
 
         void free (void *);
 
-        Slab_cache (size_t, size_t);
+        static void reclaim();
+
+        Slab_cache (size_t, size_t, bool = false);
 };
@@ -27,18 +27,67 @@
 class Sm final : public Kobject, private Queue<Ec>
 {
     private:
-        uint64_t        counter { 0 };
+        uint64_t        counter { 0 };                  // Semaphore: Counter, Notification: Pending bits
         unsigned const  id      { 0 };
+        unsigned        bit     { 0 };                  // Interrupt: Bit signaled to the target
+        Atomic<Sm *>    target  { nullptr };            // Interrupt: Notification signaled instead of this SM
+        Ec *            owner   { nullptr };            // Inheritance: EC that last acquired the semaphore
+        Queue<Ec::Waiter> any;                          // ECs waiting for any of several SMs
         Spinlock        lock;
+        bool            retired { false };              // Collected once already (see collect)
 
         static Slab_cache cache;
 
-        Sm (uint64_t, unsigned);
+        Sm (uint64_t, unsigned, Kobject::Subtype);
+
+        /*
+         * Record the owner of a semaphore with priority inheritance
+         *
+         * The owner holds a reference until it releases the semaphore.
+         *
+         * @param ec    New owner (or nullptr if none)
+         */
+        void own (Ec *ec)
+        {
+            if (owner)
+                owner->release();
+
+            owner = ec && ec->add_ref() ? ec : nullptr;
+        }
+
+        /*
+         * Remove the first EC that blocks on the SM
+         *
+         * @return      Removed EC (or nullptr if none)
+         */
+        Ec *dequeue_waiter()
+        {
+            auto const ec { dequeue_head() };
+
+            if (ec)
+                ec->blocker = nullptr;
+
+            return ec;
+        }
+
+        /*
+         * Wake the first EC that waits for any of several SMs and has not been woken already
+         *
+         * @return      Woken EC (or nullptr if none)
+         */
+        Ec *wake_any()
+        {
+            for (Ec::Waiter *w; (w = any.dequeue_head()); )
+                if (w->ec->hit (static_cast<uint8_t>(w - w->ec->wait + 1)))
+                    return w->ec;
+
+            return nullptr;
+        }
 
     public:
-        [[nodiscard]] static Sm *create (Status &s, uint64_t c, unsigned i)
+        [[nodiscard]] static Sm *create (Status &s, uint64_t c, unsigned i, Kobject::Subtype st)
         {
-            auto const sm { new (cache) Sm (c, i) };
+            auto const sm { new (cache) Sm (c, i, st) };
 
             if (EXPECT_FALSE (!sm))
                 s = Status::MEM_OBJ;
@@ -48,32 +97,101 @@ class Sm final : public Kobject, private Queue<Ec>
 
         void destroy() { operator delete (this, cache); }
 
+        [[noreturn]]
+        static void dn_any (Ec *, uint64_t);
+
+        [[noreturn]]
+        static void finish_any (Ec *);
+
+        static void unwait (Ec *);
+
+        void cancel (Ec *);
+
+        void collect();
+
         auto get_id() const { return id; }
 
-        void dn (Ec *const self, bool zero, uint64_t t)
+        auto is_notification() const { return subtype == Kobject::Subtype::SM_NOTIFICATION; }
+
+        auto is_inheriting() const { return subtype == Kobject::Subtype::SM_INHERITANCE; }
+
+        auto is_bound() const { return !!target; }
+
+        void bind (Sm *, unsigned);
+
+        void signal (uint64_t);
+
+        /*
+         * Signal an interrupt to this SM or to the notification it is bound to
+         */
+        void trigger()
+        {
+            auto const n { target.load() };
+
+            if (n)
+                n->signal (BIT64 (bit));
+            else
+                up();
+        }
+
+        /*
+         * Down operation
+         *
+         * If the semaphore inherits priorities and is held by an EC on the
+         * same core, a caller without a timeout does not block, but returns
+         * that EC so that it can lend its SC to the holder.
+         *
+         * @param self  Calling EC
+         * @param zero  Decrement the counter to zero
+         * @param t     Timeout (or 0 if none)
+         * @param inh   Permit inheritance
+         * @return      Holder to help (or nullptr otherwise)
+         */
+        Ec *dn (Ec *const self, bool zero, uint64_t t, bool inh = true)
         {
             {   Lock_guard <Spinlock> guard { lock };
 
+                // A notification returns and clears the pending bits
+                if (counter && is_notification()) {
+                    self->set_result (counter);
+                    counter = 0;
+                    return nullptr;
+                }
+
                 if (counter) {
                     counter = zero ? 0 : counter - 1;
-                    return;
+
+                    if (is_inheriting())
+                        own (self);
+
+                    return nullptr;
                 }
 
+                // The caller lends its SC to a holder on the same core instead of blocking,
+                // unless it has a timeout, because helping cannot be bounded in time
+                if (inh && !t && owner && owner != self && owner->get_cpu() == self->get_cpu())
+                    return owner;
+
                 // The EC can no longer be activated
                 self->block();
 
                 enqueue_tail (self);
+
+                self->blocker = this;
             }
 
             // At this point remote cores can unblock the EC
 
             if (self->block_sc()) {
 
-                if (t)
+                // The timeout holds a reference until the EC resumes
+                if (t && add_ref())
                     self->set_timeout (t, this);
 
                 Scheduler::schedule (true);
             }
+
+            return nullptr;
         }
 
         bool up()
@@ -82,7 +200,17 @@ class Sm final : public Kobject, private Queue<Ec>
 
             {   Lock_guard <Spinlock> guard { lock };
 
-                if (!(ec = dequeue_head())) {
+                // The EC can now be activated again
+                if ((ec = dequeue_waiter()))
+                    ec->unblock (Ec::sys_finish<Status::SUCCESS, true>, false);
+                else if ((ec = wake_any()))
+                    ec->unblock (finish_any, false);
+
+                // Ownership passes to the woken EC, if any
+                if (is_inheriting())
+                    own (ec);
+
+                if (!ec) {
 
                     if (counter == ~0ULL)
                         return false;
@@ -91,9 +219,6 @@ class Sm final : public Kobject, private Queue<Ec>
 
                     return true;
                 }
-
-                // The EC can now be activated again
-                ec->unblock (Ec::sys_finish<Status::SUCCESS, true>, false);
             }
 
             ec->unblock_sc();
@@ -109,10 +234,16 @@ class Sm final : public Kobject, private Queue<Ec>
                 if (!ec->blocked())
                     return;
 
-                dequeue (ec);
-
                 // The EC can now be activated again
-                ec->unblock (Ec::sys_finish<Status::TIMEOUT>, true);
+                if (ec->wait_cnt) {
+                    if (!ec->hit (Ec::hit_timeout))
+                        return;
+                    ec->unblock (finish_any, true);
+                } else {
+                    dequeue (ec);
+                    ec->blocker = nullptr;
+                    ec->unblock (Ec::sys_finish<Status::TIMEOUT, true>, true);
+                }
             }
 
             ec->unblock_sc();
@@ -21,9 +21,11 @@
 
 #pragma once
 
+#include "atomic.hpp"
 #include "bits.hpp"
 #include "memattr.hpp"
 #include "memory.hpp"
+#include "numa.hpp"
 #include "paging.hpp"
 #include "space.hpp"
 
@@ -31,6 +33,8 @@ template <typename T>
 class Space_mem : public Space
 {
     protected:
+        Atomic<Numa::node_t> node { Numa::local };      // Preferred NUMA node for page tables
+
         inline Space_mem (Kobject::Subtype s, Pd *p) : Space (s, p) {}
 
         static void user_access (T &mem, uint64_t addr, size_t size, bool a, Memattr ma)
@@ -40,5 +44,19 @@ class Space_mem : public Space
         }
 
     public:
-        Status delegate (Space_hst const *, unsigned long, unsigned long, unsigned, unsigned, Memattr);
+        Status delegate (Space_hst const *, unsigned long, unsigned long, unsigned, unsigned, Memattr, bool = true);
+
+        /*
+         * Allocate page tables from the NUMA node of the first core that uses the space
+         *
+         * Without such a core, page tables come from the node of the core
+         * that updates the space.
+         *
+         * @param n     NUMA node of the core
+         */
+        inline void home (Numa::node_t n)
+        {
+            Numa::node_t o { Numa::local };
+            node.compare_exchange (o, n);
+        }
 };
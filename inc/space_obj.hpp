@@ -31,11 +31,50 @@ class Space_obj final : public Space
     private:
         struct Captable;
 
-        Atomic<Captable *> root { nullptr };
+        /*
+         * Capability Cache Entry
+         *
+         * Generations are unique across all object spaces, so an entry can
+         * only match the space (and its current version) that filled it.
+         */
+        struct Cache_entry
+        {
+            uint64_t        gen { 0 };
+            unsigned long   sel { 0 };
+            Kobject *       obj { nullptr };
+            unsigned        prm { 0 };
+        };
+
+        static constexpr unsigned cache_entries { 16 };
+
+        static inline Atomic<uint64_t> generations { 0 };      // Generation Source
+
+        static Cache_entry capcache[cache_entries] CPULOCAL;    // Capability Cache (per Core)
+
+        Atomic<Captable *> root { nullptr };                    // Root of the full tree
+        Atomic<Captable *> low  { nullptr };                    // Root of the low selectors
+        Atomic<Captable *> top  { nullptr };                    // Root of the top selectors
+        Atomic<uint64_t>   gen  { ++generations };              // Generation of this Space
+
+        // Invalidate all cached capabilities of this space
+        inline void invalidate() { gen = ++generations; }
 
-        static constexpr auto lev { 2 };
+        static constexpr auto lev { 3 };                        // Levels of the full tree
+        static constexpr auto lev_low { 2 };                    // Levels of the low subtree
+        static constexpr auto lev_top { 1 };                    // Levels of the top subtree
         static constexpr auto bpl { bit_scan_reverse (PAGE_SIZE / sizeof (Captable *)) };
 
+        static_assert (lev > lev_low && lev_low > lev_top);
+
+        // Selectors below this bound are reached via the low root, skipping the upper levels
+        static constexpr auto selectors_low { BIT64 (lev_low * bpl) };
+
+        // Selectors from this bound are reached via the top root, which holds the special selectors
+        static constexpr auto selectors_top { BIT64 (lev * bpl) - BIT64 (lev_top * bpl) };
+
+        // Levels of the tree that covers a selector
+        static constexpr auto levels (unsigned long sel) { return sel < selectors_low ? lev_low : sel >= selectors_top ? lev_top : lev; }
+
         inline Space_obj() : Space (Kobject::Subtype::OBJ, nullptr)
         {
             insert (Selector::NOVA_OBJ, Capability (this, std::to_underlying (Capability::Perm_sp::TAKE)));
@@ -47,6 +86,8 @@ class Space_obj final : public Space
 
         Atomic<Capability> *walk (unsigned long, bool);
 
+        Atomic<Capability> const *leaf (unsigned long) const;
+
     public:
         static Space_obj nova;
 
@@ -67,6 +108,9 @@ class Space_obj final : public Space
             NOVA_CPU = 0,
         };
 
+        // The special selectors at the end of the space are covered by the top root
+        static_assert (ROOT_PIO >= selectors_top);
+
         [[nodiscard]] static inline Space_obj *create (Status &s, Slab_cache &cache, Pd *pd)
         {
             auto const obj { new (cache) Space_obj (pd) };
@@ -77,9 +121,13 @@ class Space_obj final : public Space
             return obj;
         }
 
-        inline void destroy (Slab_cache &cache) { operator delete (this, cache); }
+        inline void destroy (Slab_cache &cache) { this->~Space_obj(); operator delete (this, cache); }
+
+        // Generation of this space, which changes whenever any of its capabilities changes
+        inline auto generation() const { return gen.load(); }
 
         Capability lookup (unsigned long) const;
+        Capability lookup_cached (unsigned long) const;
         Status     update (unsigned long, Capability, Capability &);
         Status     insert (unsigned long, Capability);
 
@@ -29,8 +29,24 @@ inline void *memcpy (void *d, void const *s, size_t n)
     auto dst { static_cast<char *>(d) };
     auto src { static_cast<char const *>(s) };
 
+#if defined(__x86_64__)
+    // Enhanced REP MOVSB moves whole cache lines internally
+    asm volatile ("rep movsb" : "+D" (dst), "+S" (src), "+c" (n) : : "memory");
+#else
+#if defined(__aarch64__)
+    // If both pointers have the same alignment, copy 16 bytes at a time
+    if (!((reinterpret_cast<uintptr_t>(dst) ^ reinterpret_cast<uintptr_t>(src)) % sizeof (uint64_t))) {
+
+        for (; n && reinterpret_cast<uintptr_t>(dst) % sizeof (uint64_t); n--)
+            *dst++ = *src++;
+
+        for (uint64_t x, y; n >= 2 * sizeof (uint64_t); n -= 2 * sizeof (uint64_t))
+            asm volatile ("ldp %0, %1, [%2], #16; stp %0, %1, [%3], #16" : "=&r" (x), "=&r" (y), "+r" (src), "+r" (dst) : : "memory");
+    }
+#endif
     while (n--)
         *dst++ = *src++;
+#endif
 
     return d;
 }
@@ -40,8 +56,42 @@ inline void *memset (void *d, int c, size_t n)
 {
     auto dst { static_cast<char *>(d) };
 
+#if defined(__x86_64__)
+    // Enhanced REP STOSB stores whole cache lines internally
+    asm volatile ("rep stosb" : "+D" (dst), "+c" (n) : "a" (c) : "memory");
+#else
+#if defined(__aarch64__)
+    for (; n && reinterpret_cast<uintptr_t>(dst) % sizeof (uint64_t); n--)
+        *dst++ = static_cast<char>(c);
+
+    // Zero whole blocks with DC ZVA unless prohibited (DCZID_EL0.DZP)
+    if (!c) {
+
+        uint64_t dczid;
+        asm volatile ("mrs %0, dczid_el0" : "=r" (dczid));
+
+        if (!(dczid & 0x10)) {
+
+            auto const bs { sizeof (uint32_t) << (dczid & 0xf) };
+
+            if (n >= 2 * bs) {
+
+                for (; reinterpret_cast<uintptr_t>(dst) % bs; n -= sizeof (uint64_t))
+                    asm volatile ("str xzr, [%0], #8" : "+r" (dst) : : "memory");
+
+                for (; n >= bs; n -= bs, dst += bs)
+                    asm volatile ("dc zva, %0" : : "r" (dst) : "memory");
+            }
+        }
+    }
+
+    // Store 16 bytes at a time
+    for (auto const v { static_cast<uint8_t>(c) * 0x0101010101010101UL }; n >= 2 * sizeof (uint64_t); n -= 2 * sizeof (uint64_t))
+        asm volatile ("stp %1, %1, [%0], #16" : "+r" (dst) : "r" (v) : "memory");
+#endif
     while (n--)
         *dst++ = static_cast<char>(c);
+#endif
 
     return d;
 }
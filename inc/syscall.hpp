@@ -33,6 +33,8 @@ struct Sys_ipc_call final : private Sys_abi
 
     inline bool timeout() const { return flags() & BIT (0); }
 
+    inline bool short_msg() const { return flags() & BIT (1); }
+
     inline unsigned long pt() const { return p0() >> 8; }
 
     inline Mtd_user mtd() const { return Mtd_user (uint32_t (p1())); }
@@ -42,11 +44,30 @@ struct Sys_ipc_reply final : private Sys_abi
 {
     inline Sys_ipc_reply (Sys_regs &r) : Sys_abi (r) {}
 
+    inline bool short_msg() const { return flags() & BIT (1); }
+
     inline Mtd_arch mtd_a() const { return Mtd_arch (uint32_t (p1())); }
 
     inline Mtd_user mtd_u() const { return Mtd_user (uint32_t (p1())); }
 };
 
+/*
+ * Short message: words that travel in the registers p2-p4 instead of the UTCB
+ */
+struct Sys_ipc_short final : private Sys_abi
+{
+    inline Sys_ipc_short (Sys_regs &r) : Sys_abi (r) {}
+
+    inline void copy (Sys_regs &r) const
+    {
+        Sys_abi dst { r };
+
+        dst.p2() = p2();
+        dst.p3() = p3();
+        dst.p4() = p4();
+    }
+};
+
 struct Sys_create_pd final : private Sys_abi
 {
     inline Sys_create_pd (Sys_regs &r) : Sys_abi (r) {}
@@ -81,17 +102,35 @@ struct Sys_create_sc final : private Sys_abi
 {
     inline Sys_create_sc (Sys_regs &r) : Sys_abi (r) {}
 
+    inline bool mig() const { return flags() & BIT (0); }
+
+    inline bool edf() const { return flags() & BIT (1); }
+
+    inline bool grp() const { return flags() & BIT (2); }
+
+    inline bool par() const { return flags() & BIT (3); }
+
     inline unsigned long sel() const { return p0() >> 8; }
 
     inline unsigned long pd() const { return p1(); }
 
     inline unsigned long ec() const { return p2(); }
 
+    inline unsigned long parent() const { return p2(); }
+
+    inline cpu_t cpu() const { return p3() & BIT_RANGE (15, 0); }
+
     inline uint16_t budget() const { return p3() & BIT_RANGE (15, 0); }
 
     inline uint8_t prio() const { return p3() >> 16 & BIT_RANGE (6, 0); }
 
     inline uint16_t cos() const { return p3() >> 23 & BIT_RANGE (15, 0); }
+
+    inline uint32_t edf_budget() const { return p4() & BIT_RANGE (20, 0); }
+
+    inline uint32_t edf_deadline() const { return p4() >> 21 & BIT_RANGE (20, 0); }
+
+    inline uint32_t edf_period() const { return p4() >> 42 & BIT_RANGE (20, 0); }
 };
 
 struct Sys_create_pt final : private Sys_abi
@@ -111,6 +150,10 @@ struct Sys_create_sm final : private Sys_abi
 {
     inline Sys_create_sm (Sys_regs &r) : Sys_abi (r) {}
 
+    inline bool ntf() const { return flags() & BIT (0); }
+
+    inline bool inh() const { return flags() & BIT (1); }
+
     inline unsigned long sel() const { return p0() >> 8; }
 
     inline unsigned long pd() const { return p1(); }
@@ -150,8 +193,12 @@ struct Sys_ctrl_sc final : private Sys_abi
 {
     inline Sys_ctrl_sc (Sys_regs &r) : Sys_abi (r) {}
 
+    inline bool join() const { return flags() & BIT (0); }
+
     inline unsigned long sc() const { return p0() >> 8; }
 
+    inline unsigned long grp() const { return p1(); }
+
     inline void set_time_ticks (uint64_t val) { p1() = val; }
 };
 
@@ -174,9 +221,15 @@ struct Sys_ctrl_sm final : private Sys_abi
 
     inline bool zc() const { return flags() & BIT (1); }
 
+    inline bool any() const { return flags() & BIT (2); }
+
     inline unsigned long sm() const { return p0() >> 8; }
 
+    inline unsigned long cnt() const { return p0() >> 8; }
+
     inline uint64_t time_ticks() const { return p1(); }
+
+    inline uint64_t bits() const { return p1(); }
 };
 
 struct Sys_ctrl_hw final : private Sys_abi
@@ -200,6 +253,14 @@ struct Sys_assign_int final : private Sys_abi
 
     inline auto dev() const { return static_cast<uint16_t> (p2()); }
 
+    inline unsigned long ntf() const { return p3(); }
+
+    inline unsigned bit() const { return p4() & BIT_RANGE (5, 0); }
+
+    inline bool bind() const { return p4() & BIT (6); }
+
+    inline bool unbind() const { return p4() & BIT (7); }
+
     inline void set_msi_addr (uint32_t val) { p1() = val; }
 
     inline void set_msi_data (uint16_t val) { p2() = val; }
@@ -215,3 +276,12 @@ struct Sys_assign_dev final : private Sys_abi
 
     inline auto dad() const { return p2(); }
 };
+
+struct Sys_multicall final : private Sys_abi
+{
+    inline Sys_multicall (Sys_regs &r) : Sys_abi (r) {}
+
+    inline unsigned long cnt() const { return p0() >> 8; }
+
+    inline void set_done (unsigned n) { p1() = n; }
+};
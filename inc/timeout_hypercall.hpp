@@ -35,4 +35,9 @@ class Timeout_hypercall final : public Timeout
         Timeout_hypercall (Ec *e) : ec (e) {}
 
         void enqueue (uint64_t t, Sm *s) { sm = s; Timeout::enqueue (t); }
+
+        void dequeue();
+
+        // Determine if the timeout still holds a reference to an SM
+        bool armed() const { return sm; }
 };
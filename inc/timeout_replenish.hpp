@@ -0,0 +1,33 @@
+/*
+ * Replenishment Timeout
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "timeout.hpp"
+
+class Sc;
+
+class Timeout_replenish final : public Timeout
+{
+    private:
+        Sc * const  sc  { nullptr };
+
+        void trigger() override;
+
+    public:
+        Timeout_replenish (Sc *s) : sc (s) {}
+};
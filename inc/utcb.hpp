@@ -33,8 +33,74 @@ class Utcb final
         };
 
     public:
+        /*
+         * Typed Item: Delegation of a range of the HST or OBJ space of the
+         * sender into the receive window of the receiver
+         *
+         * sel: Selector base (63:12), Permissions (11:7), Order (6:2), Type (1:0)
+         * hot: Hotspot, i.e., offset of the delegation in the receive window
+         */
+        struct Item
+        {
+            enum class Type : unsigned
+            {
+                NONE    = 0,
+                HST     = 1,
+                OBJ     = 2,
+            };
+
+            uintptr_t sel, hot;
+
+            inline auto type() const { return Type (sel & BIT_RANGE (1, 0)); }
+            inline auto ord()  const { return static_cast<unsigned>(sel >> 2 & BIT_RANGE (4, 0)); }
+            inline auto pmm()  const { return static_cast<unsigned>(sel >> 7 & BIT_RANGE (4, 0)); }
+            inline auto base() const { return static_cast<unsigned long>(sel >> 12); }
+        };
+
+        /*
+         * Receive Window: Selector base (63:12), Open (5), Order (4:0)
+         */
+        struct Window
+        {
+            uintptr_t val;
+
+            inline bool open() const { return val & BIT (5); }
+            inline auto ord()  const { return static_cast<unsigned>(val & BIT_RANGE (4, 0)); }
+            inline auto base() const { return static_cast<unsigned long>(val >> 12); }
+        };
+
+        static constexpr unsigned typed_max  { (Mtd_user::items - 2) / 2 };     // Typed items
+
+        static constexpr unsigned mc_words   { 5 };                             // Words per multicall entry
+        static constexpr unsigned mc_entries { Mtd_user::items / mc_words };    // Multicall entries
+
         inline auto arch() { return &state; }
 
+        /*
+         * Multicall entry: the hypercall parameters p0-p4, with the status
+         * and the results of the hypercall replacing p0-p2 upon completion
+         *
+         * @param i     Entry index
+         * @return      Pointer to the entry
+         */
+        inline auto mc_entry (unsigned i) { return mr + i * mc_words; }
+
+        /*
+         * Selector list, e.g., of the SMs for a wait-for-any operation
+         *
+         * @param i     Index
+         * @return      Selector
+         */
+        inline auto sel (unsigned i) const { return static_cast<unsigned long>(mr[i]); }
+
+        /*
+         * The receive windows occupy the last two words, followed by the typed items in descending order
+         */
+        inline auto wnd_hst() const { return Window { mr[Mtd_user::items - 1] }; }
+        inline auto wnd_obj() const { return Window { mr[Mtd_user::items - 2] }; }
+
+        inline auto item (unsigned i) const { return Item { mr[Mtd_user::items - 4 - 2 * i], mr[Mtd_user::items - 3 - 2 * i] }; }
+
         inline void copy (Mtd_user const mtd, Utcb *dst) const
         {
             for (unsigned i { 0 }; i < mtd.count(); i++)
@@ -44,12 +110,13 @@ class Utcb final
         /*
          * Allocate UTCB
          *
+         * @param node  Preferred NUMA node
          * @return      Pointer to the UTCB (allocation success) or nullptr (allocation failure)
          */
-        [[nodiscard]] static void *operator new (size_t) noexcept
+        [[nodiscard]] static void *operator new (size_t, Numa::node_t node) noexcept
         {
             static_assert (sizeof (Utcb) <= PAGE_SIZE);
-            return Buddy::alloc (0, Buddy::Fill::BITS0);
+            return Buddy::alloc (0, Buddy::Fill::BITS0, node);
         }
 
         /*
@@ -30,8 +30,8 @@ class Sys_abi
         auto       &p0() const { return s.rdi; }
         auto       &p1() const { return s.rsi; }
         auto       &p2() const { return s.rdx; }
-        auto const &p3() const { return s.rax; }
-        auto const &p4() const { return s.r8;  }
+        auto       &p3() const { return s.rax; }
+        auto       &p4() const { return s.r8;  }
 
         ALWAYS_INLINE uint8_t flags() const { return p0() >> 4 & BIT_RANGE (3, 0); }
 };
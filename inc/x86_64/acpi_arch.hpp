@@ -27,6 +27,7 @@
 #include "acpi_table_lpit.hpp"
 #include "acpi_table_mcfg.hpp"
 #include "acpi_table_rsdp.hpp"
+#include "acpi_table_srat.hpp"
 #include "ptab_hpt.hpp"
 #include "string.hpp"
 
@@ -76,6 +77,8 @@ class Acpi_arch
                 static_cast<Acpi_table_dmar *>(Hptp::map (dmar))->parse();
             if (lpit)
                 static_cast<Acpi_table_lpit *>(Hptp::map (lpit))->parse();
+            if (srat)
+                static_cast<Acpi_table_srat *>(Hptp::map (srat))->parse();
         }
 
         static void wake_prepare()
@@ -95,7 +98,7 @@ class Acpi_arch
                 static_cast<Acpi_table_facs *>(Hptp::map (facs, true))->set_wake (sipi + static_cast<uint32_t>(&__wake_vec - &__init_aps));
         }
 
-        static inline uint64_t dbg2 { 0 }, dmar { 0 }, facs { 0 }, fadt { 0 }, hpet { 0 }, lpit { 0 }, madt { 0 }, mcfg { 0 }, spcr { 0 };
+        static inline uint64_t dbg2 { 0 }, dmar { 0 }, facs { 0 }, fadt { 0 }, hpet { 0 }, lpit { 0 }, madt { 0 }, mcfg { 0 }, spcr { 0 }, srat { 0 };
 
     public:
         static constexpr auto sipi { PAGE_SIZE };
@@ -117,6 +120,7 @@ class Acpi_arch
             { Signature::value ("LPIT"), lpit },
             { Signature::value ("MCFG"), mcfg },
             { Signature::value ("SPCR"), spcr },
+            { Signature::value ("SRAT"), srat },
         };
 
         static void wake_restore()
@@ -0,0 +1,104 @@
+/*
+ * Advanced Configuration and Power Interface (ACPI)
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "acpi_table.hpp"
+
+/*
+ * 5.2.16: System Resource Affinity Table (SRAT)
+ */
+class Acpi_table_srat final
+{
+    private:
+        Acpi_table  table;                              //  0
+        uint32_t    reserved1;                          // 36
+        uint32_t    reserved2[2];                       // 40
+
+        /*
+         * Each Affinity struct is only 32bit (but not 64bit) aligned. This is because
+         * the structs have a multiple-of-4 size (but not all a multiple-of-8 size).
+         */
+        struct Affinity
+        {
+            enum Type : uint8_t
+            {
+                LAPIC   = 0,                            // Processor Local APIC/SAPIC Affinity
+                MEM     = 1,                            // Memory Affinity
+                X2APIC  = 2,                            // Processor Local x2APIC Affinity
+            };
+
+            enum Flags : uint32_t
+            {
+                ENABLED             = BIT (0),
+            };
+
+            Type        type;                           //  0 + n
+            uint8_t     length;                         //  1 + n
+        };
+
+        /*
+         * 5.2.16.1: Processor Local APIC/SAPIC Affinity Structure
+         */
+        struct Affinity_lapic : Affinity
+        {
+            uint8_t     pxm_lo;                         //  2 + n
+            uint8_t     id;                             //  3 + n
+            Flags       flags;                          //  4 + n
+            uint8_t     eid;                            //  8 + n
+            uint8_t     pxm_hi[3];                      //  9 + n
+            uint32_t    clock_domain;                   // 12 + n
+                                                        // 16 + n
+            void parse() const;
+        };
+
+        /*
+         * 5.2.16.2: Memory Affinity Structure
+         */
+        struct Affinity_mem : Affinity
+        {
+            uint16_t    pxm_lo, pxm_hi;                 //  2 + n
+            uint16_t    reserved1;                      //  6 + n
+            uint32_t    phys_base_lo, phys_base_hi;     //  8 + n
+            uint32_t    size_lo, size_hi;               // 16 + n
+            uint32_t    reserved2;                      // 24 + n
+            Flags       flags;                          // 28 + n
+            uint32_t    reserved3[2];                   // 32 + n
+                                                        // 40 + n
+            void parse() const;
+        };
+
+        /*
+         * 5.2.16.3: Processor Local x2APIC Affinity Structure
+         */
+        struct Affinity_x2apic : Affinity
+        {
+            uint16_t    reserved1;                      //  2 + n
+            uint32_t    pxm;                            //  4 + n
+            uint32_t    id;                             //  8 + n
+            Flags       flags;                          // 12 + n
+            uint32_t    clock_domain;                   // 16 + n
+            uint32_t    reserved2;                      // 20 + n
+                                                        // 24 + n
+            void parse() const;
+        };
+
+    public:
+        void parse() const;
+};
+
+static_assert (__is_standard_layout (Acpi_table_srat) && sizeof (Acpi_table_srat) == 48);
@@ -36,6 +36,9 @@ class Counter final
         static Counter loc[NUM_LVT] CPULOCAL;
         static Counter schedule     CPULOCAL;
         static Counter helping      CPULOCAL;
+        static Counter remote       CPULOCAL;
+        static Counter slab_reuse   CPULOCAL;   // Slabs reused instead of allocated
+        static Counter slab_reclaim CPULOCAL;   // Slabs reclaimed under memory pressure
 
         ALWAYS_INLINE
         inline void inc()
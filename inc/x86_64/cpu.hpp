@@ -228,6 +228,8 @@ class Cpu final
 
         static cpu_t        id              CPULOCAL_HOT;
         static apic_t       topology        CPULOCAL_HOT;
+        static uint32_t     core_id         CPULOCAL;       // Physical core (shared by SMT threads)
+        static uint32_t     pkg_id          CPULOCAL;       // Package (shared last-level cache)
         static unsigned     hazard          CPULOCAL_HOT;
         static Vendor       vendor          CPULOCAL;
         static unsigned     platform        CPULOCAL;
@@ -255,6 +257,14 @@ class Cpu final
             features[std::to_underlying (f) / 32] &= ~BIT (std::to_underlying (f) % 32);
         }
 
+        /*
+         * Determine if all cores are online
+         *
+         * If so, the CPU-local area of the current core is accessible, which
+         * is not the case during early boot and during resume from sleep.
+         */
+        static bool all_online() { auto const n { online.load() }; return n && n == count; }
+
         static void preemption_disable()    { asm volatile ("cli" : : : "memory"); }
         static void preemption_enable()     { asm volatile ("sti" : : : "memory"); }
         static void preemption_point()      { asm volatile ("sti; nop; cli" : : : "memory"); }
@@ -272,6 +282,17 @@ class Cpu final
 
         static auto remote_topology (cpu_t c) { return *Kmem::loc_to_glob (&topology, c); }
 
+        /*
+         * Determine the topological distance of another core
+         *
+         * @param c     Core
+         * @return      0 (SMT sibling), 1 (same package), 2 (otherwise)
+         */
+        static unsigned distance (cpu_t c)
+        {
+            return *Kmem::loc_to_glob (&core_id, c) == core_id ? 0 : *Kmem::loc_to_glob (&pkg_id, c) == pkg_id ? 1 : 2;
+        }
+
         static auto find_by_topology (uint32_t t)
         {
             for (cpu_t c { 0 }; c < count; c++)
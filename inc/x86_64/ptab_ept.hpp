@@ -95,6 +95,15 @@ class Eptp final : public Ptab<Ept, uint64_t, uint64_t>
             asm volatile ("invept %1, %2" : "=@cca" (ret) : "m" (desc), "r" (1UL) : "memory");
             assert (ret);
         }
+
+        static void invalidate_all()
+        {
+            struct { uint64_t eptp, rsvd; } desc = { 0, 0 };
+
+            bool ret;
+            asm volatile ("invept %1, %2" : "=@cca" (ret) : "m" (desc), "r" (2UL) : "memory");
+            assert (ret);
+        }
 };
 
 // Sanity checks
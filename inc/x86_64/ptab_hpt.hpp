@@ -138,19 +138,19 @@ class Hptp final : public Ptab<Hpt, uint64_t, uint64_t>
         }
 
         ALWAYS_INLINE
-        inline bool share_from_master (IAddr v)
+        inline bool share_from_master (IAddr v, Numa::node_t n = Numa::local)
         {
-            return share_from (master, v, MMAP_CPU);
+            return share_from (master, v, MMAP_CPU, n);
         }
 
         ALWAYS_INLINE
-        inline void share_from_master (IAddr s, IAddr e)
+        inline void share_from_master (IAddr s, IAddr e, Numa::node_t n = Numa::local)
         {
             for (unsigned l = (bit_scan_reverse (LINK_ADDR ^ MMAP_CPU) - PAGE_BITS) / Hpt::bpl; s < e; s += BITN (l * Hpt::bpl + PAGE_BITS))
-                share_from_master (s);
+                share_from_master (s, n);
         }
 
-        bool share_from (Hptp, IAddr, IAddr);
+        bool share_from (Hptp, IAddr, IAddr, Numa::node_t = Numa::local);
 
         static void *map (OAddr, bool = false);
 };
@@ -196,6 +196,8 @@ class Smmu final : public List<Smmu>
 
                 auto did() const { return static_cast<uint16_t>(hi >> 8); }
 
+                auto lev() const { return static_cast<unsigned>(hi & BIT_RANGE (2, 0)); }
+
                 void set (uint64_t h, uint64_t l) { hi = h; lo = l; Cache::data_clean (this); }
 
                 [[nodiscard]] static void *operator new (size_t) noexcept
@@ -530,6 +532,8 @@ class Smmu final : public List<Smmu>
 
         bool configure (Space_dma *, uintptr_t, bool = true);
 
+        static void detach_all (Space_dma *);
+
         static void set_irte (uint16_t idx, uint16_t src, apic_t dst, uint8_t vec, bool trg)
         {
             if (EXPECT_FALSE (!ir))
@@ -60,7 +60,14 @@ class Space_dma final : public Space_mem<Space_dma>
             return nullptr;
         }
 
-        inline void destroy (Slab_cache &cache) { operator delete (this, cache); }
+        inline void destroy (Slab_cache &cache)
+        {
+            Smmu::detach_all (this);
+
+            dptp.root_fini();
+
+            operator delete (this, cache);
+        }
 
         inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return dptp.update (v, p, o, pm, ma); }
 
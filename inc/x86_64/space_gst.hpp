@@ -31,6 +31,9 @@ class Space_gst final : public Space_mem<Space_gst>
     private:
         Eptp    eptp;
 
+        static inline Atomic<unsigned> retired { 0 };  // Number of destroyed GST spaces
+        static unsigned flushed CPULOCAL;               // Value of retired at the last flush on this core
+
         inline Space_gst (Pd *p) : Space_mem (Kobject::Subtype::GST, p) {}
 
     public:
@@ -56,15 +59,42 @@ class Space_gst final : public Space_mem<Space_gst>
             return nullptr;
         }
 
-        inline void destroy (Slab_cache &cache) { operator delete (this, cache); }
+        inline void destroy (Slab_cache &cache)
+        {
+            retired++;
+
+            eptp.root_fini();
+
+            operator delete (this, cache);
+        }
 
         inline auto lookup (uint64_t v, uint64_t &p, unsigned &o, Memattr &ma) const { return eptp.lookup (v, p, o, ma); }
 
-        inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return eptp.update (v, p, o, pm, ma); }
+        inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return eptp.update (v, p, o, pm, ma, node); }
 
         inline void sync() { gtlb.set(); Tlb::shootdown (this); }
 
         inline void invalidate() { eptp.invalidate(); }
 
         inline auto get_phys() const { return eptp.root_addr(); }
+
+        /*
+         * Check whether this core may still cache translations of a destroyed GST space
+         *
+         * A new GST space may reuse the page tables of a destroyed one, so
+         * such translations must be flushed before the next VM entry.
+         *
+         * @return      True if the TLB must be flushed, false otherwise
+         */
+        static inline bool stale()
+        {
+            auto const r { retired.load() };
+
+            if (EXPECT_TRUE (flushed == r))
+                return false;
+
+            flushed = r;
+
+            return true;
+        }
 };
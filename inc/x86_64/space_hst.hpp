@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include "buddy.hpp"
 #include "cpu.hpp"
 #include "cpuset.hpp"
 #include "pcid.hpp"
@@ -43,13 +44,15 @@ class Space_hst final : public Space_mem<Space_hst>
         Cpuset      cpus;
         Cpuset      htlb;
 
+        Buddy::Retainlist retained;                     // Unmapped UTCBs
+
         static Space_hst nova;
         static Space_hst *current CPULOCAL;
 
         static inline auto selectors() { return BIT64 (Hpt::ibits - PAGE_BITS - 1); }
         static inline auto max_order() { return Hpt::lev_ord(); }
 
-        [[nodiscard]] inline auto get_ptab (unsigned cpu) { return loc[cpu].root_init(); }
+        [[nodiscard]] inline auto get_ptab (unsigned cpu) { return loc[cpu].root_init (Hpt::lev() - 1, Numa::node_by_cpu (static_cast<cpu_t>(cpu))); }
 
         [[nodiscard]] static inline Space_hst *create (Status &s, Slab_cache &cache, Pd *pd)
         {
@@ -68,13 +71,13 @@ class Space_hst final : public Space_mem<Space_hst>
             return nullptr;
         }
 
-        inline void destroy (Slab_cache &cache) { operator delete (this, cache); }
+        void destroy (Slab_cache &);
 
         inline auto lookup (uint64_t v, uint64_t &p, unsigned &o, Memattr &ma) const { return hptp.lookup (v, p, o, ma); }
 
-        inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return hptp.update (v, p, o, pm, ma); }
+        inline auto update (uint64_t v, uint64_t p, unsigned o, Paging::Permissions pm, Memattr ma) { return hptp.update (v, p, o, pm, ma, node); }
 
-        inline void sync() { htlb.set(); Tlb::shootdown (this); }
+        inline void sync() { retained.wait(); htlb.set(); Tlb::shootdown (this); }
 
         ALWAYS_INLINE
         inline void make_current()
@@ -99,7 +102,7 @@ class Space_hst final : public Space_mem<Space_hst>
 
         inline auto get_pcid() const { return pcid; }
 
-        void init (unsigned);
+        bool init (unsigned);
 
         static void user_access (uint64_t addr, size_t size, bool a) { Space_mem::user_access (nova, addr, size, a, Memattr::dev()); }
 };
@@ -68,7 +68,12 @@ class Space_msr final : public Space
             return nullptr;
         }
 
-        inline void destroy (Slab_cache &cache) { operator delete (this, cache); }
+        inline void destroy (Slab_cache &cache)
+        {
+            this->~Space_msr();
+
+            operator delete (this, cache);
+        }
 
         static void user_access (Msr::Register r, Paging::Permissions p) { nova.update (std::to_underlying (r), p); }
 };
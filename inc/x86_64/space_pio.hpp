@@ -42,8 +42,12 @@ class Space_pio final : public Space
 
         inline ~Space_pio()
         {
-            if (hst)
+            // An attached space holds a reference to the HST space that maps its bitmap
+            if (hst) {
                 hst->update (MMAP_SPC_PIO, 0, 1, Paging::NONE, Memattr::ram());
+                hst->htlb.set();
+                hst->release();
+            }
 
             delete bmp;
         }
@@ -61,7 +65,7 @@ class Space_pio final : public Space
         {
             auto const hst { pd->get_hst() };
 
-            if (EXPECT_FALSE (!hst)) {
+            if (EXPECT_FALSE (!hst || (a && !hst->add_ref()))) {
                 s = Status::ABORTED;
                 return nullptr;
             }
@@ -78,12 +82,20 @@ class Space_pio final : public Space
                 delete bmp;
             }
 
+            if (a)
+                hst->release();
+
             s = Status::MEM_OBJ;
 
             return nullptr;
         }
 
-        inline void destroy (Slab_cache &cache) { operator delete (this, cache); }
+        inline void destroy (Slab_cache &cache)
+        {
+            this->~Space_pio();
+
+            operator delete (this, cache);
+        }
 
         static void user_access (uint64_t base, size_t size, Paging::Permissions p)
         {
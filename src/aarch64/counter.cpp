@@ -21,3 +21,6 @@ Counter Counter::req[Intid::NUM_SGI];
 Counter Counter::loc[Intid::NUM_PPI];
 Counter Counter::schedule;
 Counter Counter::helping;
+Counter Counter::remote;
+Counter Counter::slab_reuse;
+Counter Counter::slab_reclaim;
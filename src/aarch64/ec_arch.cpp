@@ -23,9 +23,11 @@
 #include "extern.hpp"
 #include "fpu.hpp"
 #include "pd.hpp"
+#include "rcu.hpp"
 #include "sc.hpp"
 #include "space_gst.hpp"
 #include "space_hst.hpp"
+#include "space_obj.hpp"
 #include "stdio.hpp"
 #include "timer.hpp"
 #include "vmcb.hpp"
@@ -34,7 +36,7 @@
 Ec_arch::Ec_arch (cpu_t c, cont_t x) : Ec (&Space_hst::nova, c, x) {}
 
 // Constructor: HST EC
-Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Space_pio *pio, cpu_t c, unsigned long e, uintptr_t sp, uintptr_t hva, void *k) : Ec (t, f, obj, hst, pio, k, c, e, t ? send_msg<ret_user_exception> : nullptr)
+Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Space_pio *pio, cpu_t c, unsigned long e, uintptr_t sp, uintptr_t hva, void *k) : Ec (t, f, obj, hst, pio, k, hva, c, e, t ? send_msg<ret_user_exception> : nullptr)
 {
     assert (obj && hst && !pio && k);
 
@@ -48,7 +50,7 @@ Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Space_pio *pio
 }
 
 // Constructor: GST EC
-Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Vmcb *v, cpu_t c, unsigned long e, uintptr_t sp) : Ec (t, f, obj, hst, v, nullptr, c, e, set_vmm_regs)
+Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Vmcb *v, cpu_t c, unsigned long e, uintptr_t sp) : Ec (t, f, obj, hst, v, nullptr, 0, c, e, set_vmm_regs)
 {
     assert (obj && hst && v);
 
@@ -64,12 +66,13 @@ Ec *Ec::create_gst (Status &s, Pd *pd, bool t, bool fpu, cpu_t cpu, unsigned lon
     auto const obj { pd->get_obj() };
     auto const hst { pd->get_hst() };
 
-    if (EXPECT_FALSE (!obj || !hst)) {
+    if (EXPECT_FALSE (!obj || !hst || !acquire (obj, hst))) {
         s = Status::ABORTED;
         return nullptr;
     }
 
-    // FIXME: Refcount updates
+    // The page tables of the space come from the node of its first EC
+    hst->home (Numa::node_by_cpu (cpu));
 
     auto const f { fpu ? new (pd->fpu_cache) Fpu : nullptr };
     auto const v { new Vmcb };
@@ -81,11 +84,36 @@ Ec *Ec::create_gst (Status &s, Pd *pd, bool t, bool fpu, cpu_t cpu, unsigned lon
     delete v;
     Fpu::operator delete (f, pd->fpu_cache);
 
+    obj->release();
+    hst->release();
+
     s = Status::MEM_OBJ;
 
     return nullptr;
 }
 
+/*
+ * Unload the guest state of a vCPU from its core, so that it can be freed
+ */
+void Ec::unload_vcpu()
+{
+    assert (cpu == Cpu::id);
+
+    if (Vmcb::current == regs.vmcb)
+        Vmcb::load_hst();
+}
+
+/*
+ * Destroy the VMCB of a vCPU and release the reference it held to its assigned space
+ */
+void Ec::destroy_vcpu()
+{
+    delete regs.vmcb;
+
+    if (auto const gst { get_gst() })
+        gst->release();
+}
+
 void Ec::adjust_offset_ticks (uint64_t t)
 {
     if (subtype == Kobject::Subtype::EC_VCPU_OFFS)
@@ -94,6 +122,9 @@ void Ec::adjust_offset_ticks (uint64_t t)
 
 void Ec::handle_hazard (unsigned h, cont_t func)
 {
+    if (h & Hazard::RCU)
+        Rcu::quiet();
+
     if (EXPECT_FALSE (h & (Hazard::ILLEGAL | Hazard::RECALL | Hazard::SLEEP | Hazard::SCHED))) {
 
         Cpu::preemption_point();
@@ -22,6 +22,7 @@
 #include "gicd.hpp"
 #include "gicr.hpp"
 #include "interrupt.hpp"
+#include "rcu.hpp"
 #include "sc.hpp"
 #include "sm.hpp"
 #include "smmu.hpp"
@@ -75,8 +76,10 @@ Event::Selector Interrupt::handle_ppi (uint32_t val, bool vcpu)
     if (ppi == Timer::ppi_el1_v)        // Deactivation by guest
         return vcpu ? Event::Selector::VTIMER : Event::Selector::NONE;
 
-    if (ppi == Timer::ppi_el2_p)        // Deactivation by host
+    if (ppi == Timer::ppi_el2_p) {      // Deactivation by host
         Stc::interrupt();
+        Rcu::update();
+    }
 
     Gicc::dir (val);
 
@@ -92,7 +95,7 @@ Event::Selector Interrupt::handle_spi (uint32_t val, bool)
     Gicc::eoi (val);
 
     if (EXPECT_TRUE (int_table[spi].sm))
-        int_table[spi].sm->up();
+        int_table[spi].sm->trigger();
 
     else {
 
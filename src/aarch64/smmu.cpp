@@ -175,6 +175,43 @@ bool Smmu::configure (Space_dma *dma, uintptr_t dad)
     return conf_smg (smg);
 }
 
+/*
+ * Remove all stream mappings to a DMA space that is being destroyed
+ *
+ * @param dma   DMA space
+ */
+void Smmu::detach (Space_dma const *dma)
+{
+    if (!config)
+        return;
+
+    bool inv { false };
+
+    {   Lock_guard <Spinlock> guard { cfg_lock };
+
+        for (uint8_t smg { 0 }; smg < num_smg; smg++) {
+
+            if (config->entry[smg].dma != dma)
+                continue;
+
+            config->entry[smg].dma = nullptr;
+
+            // Disable SMG and generate "invalid context" fault
+            write (smg, GR0_Array32::SMR, 0);
+            write (smg, GR0_Array32::S2CR, BIT (17));
+
+            // Disable CTX
+            write (config->entry[smg].ctx, Ctx_Array32::SCTLR, 0);
+
+            inv = true;
+        }
+    }
+
+    // Invalidate stale TLB entries for SDID
+    if (inv)
+        tlb_invalidate (dma->get_sdid());
+}
+
 void Smmu::fault()
 {
     auto const gfsr { read (GR0_Register32::GFSR) };
@@ -320,7 +320,15 @@ bool Utcb_arch::assign_spaces (Cpu_regs &c, Space_obj const *obj) const
     if (EXPECT_FALSE (gst->get_pd() != c.obj->get_pd()))
         return false;
 
-    // FIXME: Refcount updates
+    // The vCPU holds a reference to its space, because hardware uses it
+    if (EXPECT_FALSE (!gst->add_ref()))
+        return false;
+
+    if (c.gst)
+        c.gst->release();
+
+    // The vCPU loads its state on its own core, whose node provides the page tables of the space
+    gst->home (Numa::node);
 
     c.gst = gst;
 
@@ -22,10 +22,14 @@
 #include "assert.hpp"
 #include "bits.hpp"
 #include "buddy.hpp"
+#include "cpu.hpp"
+#include "kmem.hpp"
 #include "lock_guard.hpp"
 #include "string.hpp"
 
 Buddy::Waitlist Buddy::waitlist;
+Buddy::Magazine Buddy::magazine[mag_orders];
+Buddy::Magazine Buddy::zeroed;
 
 /*
  * Initialize the buddy allocator
@@ -42,27 +46,85 @@ void Buddy::init()
     max_idx  = page_to_index (virt + (size / (PAGE_SIZE + sizeof (Block))) * PAGE_SIZE);
     blk_base = reinterpret_cast<Block *>(virt + size) - max_idx;
 
-    // Free all pages in the pool
-    for (auto i { reinterpret_cast<uintptr_t>(&KMEM_HVAF) }; i < index_to_page (max_idx); i += PAGE_SIZE)
-        free (reinterpret_cast<void *>(i));
+    // Carve the free part of the pool into maximal aligned blocks
+    for (auto i { page_to_index (reinterpret_cast<uintptr_t>(&KMEM_HVAF)) }; i < max_idx; ) {
+
+        auto const o { static_cast<order_t>(min (max_order (i, max_idx - i), static_cast<unsigned long>(orders - 1))) };
+
+        // Splitting a block requires each of its halves to be a free block of the next-lower order
+        for (index_t j { 1 }; j < BIT (o); j++) {
+            auto const block { index_to_block (i + j) };
+            block->ord = static_cast<order_t>(bit_scan_forward (j));
+            block->tag = Block::Tag::FREE;
+        }
+
+        auto const block { index_to_block (i) };
+        block->ord = o;
+        block->tag = Block::Tag::FREE;
+
+        freelist[0].enqueue (block);
+
+        pages += BIT (o);
+
+        i += BIT (o);
+    }
 }
 
 /*
- * Allocate physically and virtually contiguous memory region
+ * Assign all blocks to the NUMA node of their memory
  *
- * @param ord       Block order (2^ord pages)
- * @param fill      Fill pattern for the block
- * @return          Pointer to virtual memory region or nullptr if unsuccessful
+ * Called once the memory affinity of the platform is known. Free blocks
+ * whose pages belong to different nodes are split until they do not.
  */
-void *Buddy::alloc (order_t ord, Fill fill)
+void Buddy::partition()
 {
     Lock_guard <Spinlock> guard { lock };
 
+    Queue<Block> list;
+
+    // Collect all free blocks, which are still in the freelists of node 0
+    for (order_t o { 0 }; o < orders; o++)
+        for (Block *b; (b = freelist[0].dequeue (o)); list.enqueue_head (b)) ;
+
+    // Assign every page to its node
+    for (auto i { min_idx }; i < max_idx; i++)
+        index_to_block (i)->node = Numa::node_by_phys (Kmem::ptr_to_phys (reinterpret_cast<void *>(index_to_page (i))));
+
+    // Put all free blocks back into the freelists of their node
+    for (Block *b; (b = list.dequeue_head()); ) {
+
+        auto const idx { block_to_index (b) };
+
+        // Split the block if its first and last page belong to different nodes
+        if (b->ord && index_to_block (idx + BIT (b->ord) - 1)->node != b->node) {
+            auto const buddy { index_to_block (idx + BIT (--b->ord)) };
+            buddy->ord = b->ord;
+            buddy->tag = Block::Tag::FREE;
+            list.enqueue_head (b);
+            list.enqueue_head (buddy);
+            continue;
+        }
+
+        freelist[b->node].enqueue (b);
+    }
+}
+
+/*
+ * Dequeue a block from a node's freelists, splitting higher-order blocks as needed
+ *
+ * The caller must hold the allocator lock.
+ *
+ * @param fl        Freelists of the node
+ * @param ord       Block order (2^ord pages)
+ * @return          Pointer to the block or nullptr if unsuccessful
+ */
+Buddy::Block *Buddy::dequeue (Freelist &fl, order_t ord)
+{
     // Iterate over all freelists, starting with the requested order
     for (auto o { ord }; o < orders; o++) {
 
         // Get the first block from the order(o) freelist
-        auto const block { freelist.dequeue (o) };
+        auto const block { fl.dequeue (o) };
 
         // If that freelist was empty, try higher orders
         if (!block)
@@ -72,41 +134,173 @@ void *Buddy::alloc (order_t ord, Fill fill)
         while (o-- != ord) {
             auto const buddy { block + BIT (o) };
             assert (buddy->ord == o);
-            freelist.enqueue (buddy);
+            fl.enqueue (buddy);
         }
 
         // Set final block size and mark block as used
         block->ord = ord;
         block->tag = Block::Tag::USED;
 
-        auto const ptr { reinterpret_cast<void *>(index_to_page (block_to_index (block))) };
+        pages -= BIT (ord);
+
+        return block;
+    }
+
+    return nullptr;
+}
+
+/*
+ * Dequeue a block, preferring the specified node and falling back to the others
+ *
+ * The caller must hold the allocator lock.
+ *
+ * @param ord       Block order (2^ord pages)
+ * @param node      Preferred node
+ * @return          Pointer to the block or nullptr if unsuccessful
+ */
+Buddy::Block *Buddy::dequeue (order_t ord, Numa::node_t node)
+{
+    for (Numa::node_t i { 0 }; i < Numa::count; i++) {
 
-        // Fill the block if requested
-        if (fill != Fill::NONE)
-            memset (ptr, fill == Fill::BITS0 ? 0 : ~0U, BIT (block->ord + PAGE_BITS));
+        auto const block { dequeue (freelist[(node + i) % Numa::count], ord) };
 
-        return ptr;
+        if (block)
+            return block;
     }
 
-    // Out of memory
     return nullptr;
 }
 
+/*
+ * Refill the magazine of the current core with a batch of blocks
+ *
+ * @param ord       Block order (2^ord pages)
+ */
+void Buddy::refill (order_t ord)
+{
+    auto &mag { magazine[ord] };
+
+    Lock_guard <Spinlock> guard { lock };
+
+    for (unsigned i { 0 }; i < Magazine::batch; i++) {
+
+        auto const block { dequeue (ord, Numa::node) };
+
+        if (EXPECT_FALSE (!block))
+            break;
+
+        mag.enqueue (block);
+    }
+}
+
+/*
+ * Drain blocks from the magazine of the current core into the freelists
+ *
+ * @param ord       Block order (2^ord pages)
+ * @param cnt       Number of blocks to drain
+ */
+void Buddy::drain (order_t ord, unsigned cnt)
+{
+    auto &mag { magazine[ord] };
+
+    Lock_guard <Spinlock> guard { lock };
+
+    for (Block *b; cnt-- && (b = mag.dequeue()); coalesce (b)) ;
+}
+
+/*
+ * Drain all magazines of the current core into the freelists
+ */
+void Buddy::flush()
+{
+    for (order_t o { 0 }; o < mag_orders; o++)
+        drain (o, Magazine::limit);
+
+    Lock_guard <Spinlock> guard { lock };
+
+    for (Block *b; (b = zeroed.dequeue()); coalesce (b)) ;
+}
+
+/*
+ * Allocate physically and virtually contiguous memory region
+ *
+ * @param ord       Block order (2^ord pages)
+ * @param fill      Fill pattern for the block
+ * @param node      Preferred node (falls back to other nodes if exhausted)
+ * @return          Pointer to virtual memory region or nullptr if unsuccessful
+ */
+void *Buddy::alloc (order_t ord, Fill fill, Numa::node_t node)
+{
+    Block *block;
+
+    auto const online { Cpu::all_online() };
+
+    // Without CPU-local data, the booting core determines the local node
+    if (node == Numa::local)
+        node = online ? Numa::node : Numa::boot;
+
+    // Magazines only cache blocks of the node of the current core
+    auto const cached { online && node == Numa::node };
+
+    // Zero-filled order-0 blocks come from the pre-zeroed pool of the current core
+    if (EXPECT_TRUE (cached && !ord && fill == Fill::BITS0 && (block = zeroed.dequeue())))
+        return reinterpret_cast<void *>(index_to_page (block_to_index (block)));
+
+    // Low-order blocks come from the magazine of the current core
+    if (EXPECT_TRUE (cached && ord < mag_orders)) {
+
+        if (EXPECT_FALSE (magazine[ord].empty()))
+            refill (ord);
+
+        block = magazine[ord].dequeue();
+
+    } else {
+
+        Lock_guard <Spinlock> guard { lock };
+
+        block = dequeue (ord, node);
+    }
+
+    // Return cached blocks to the freelists so they can coalesce, then retry
+    if (EXPECT_FALSE (!block && online)) {
+
+        flush();
+
+        Lock_guard <Spinlock> guard { lock };
+
+        block = dequeue (ord, node);
+    }
+
+    // Out of memory
+    if (EXPECT_FALSE (!block))
+        return nullptr;
+
+    auto const ptr { reinterpret_cast<void *>(index_to_page (block_to_index (block))) };
+
+    // Fill the block if requested
+    if (fill != Fill::NONE)
+        memset (ptr, fill == Fill::BITS0 ? 0 : ~0U, BIT (block->ord + PAGE_BITS));
+
+    return ptr;
+}
+
 /*
  * Coalesce to-be-freed block
  *
+ * The caller must hold the allocator lock.
+ *
  * @param block     Pointer to the block
  */
 void Buddy::coalesce (Block *block)
 {
-    Lock_guard <Spinlock> guard { lock };
-
     // Ensure block was used
     assert (block->tag == Block::Tag::USED);
 
     // Mark block as free
     block->tag = Block::Tag::FREE;
 
+    pages += BIT (block->ord);
+
     // Coalesce adjacent order(o) blocks into an order(o+1) block
     for (auto o { block->ord }; o < orders - 1; block->ord = ++o) {
 
@@ -119,12 +313,12 @@ void Buddy::coalesce (Block *block)
 
         auto const buddy { index_to_block (buddy_idx) };
 
-        // Stop if buddy is not free or fragmented
-        if (buddy->tag != Block::Tag::FREE || buddy->ord != o)
+        // Stop if buddy is not free or fragmented or on another node
+        if (buddy->tag != Block::Tag::FREE || buddy->ord != o || buddy->node != block->node)
             break;
 
         // Dequeue buddy from the freelist
-        freelist.dequeue (buddy);
+        freelist[buddy->node].dequeue (buddy);
 
         // Merge block with buddy
         if (block > buddy)
@@ -132,7 +326,7 @@ void Buddy::coalesce (Block *block)
     }
 
     // Put final-size block into the freelist
-    freelist.enqueue (block);
+    freelist[block->node].enqueue (block);
 }
 
 /*
@@ -150,8 +344,25 @@ void Buddy::free (void *ptr)
     // Ensure memory is within allocator range
     assert (valid (idx));
 
+    auto const block { index_to_block (idx) };
+
+    // Low-order blocks of the local node go into the magazine of the current core
+    if (EXPECT_TRUE (block->ord < mag_orders && Cpu::all_online() && block->node == Numa::node)) {
+
+        auto &mag { magazine[block->ord] };
+
+        if (EXPECT_FALSE (mag.full()))
+            drain (block->ord, Magazine::batch);
+
+        mag.enqueue (block);
+
+        return;
+    }
+
+    Lock_guard <Spinlock> guard { lock };
+
     // Coalesce to-be-freed block
-    coalesce (index_to_block (idx));
+    coalesce (block);
 }
 
 /*
@@ -172,3 +383,92 @@ void Buddy::wait (void *ptr)
     // Waitlist to-be-freed block
     waitlist.enqueue (index_to_block (idx));
 }
+
+/*
+ * Free all waitlisted memory regions of the current core
+ */
+void Buddy::free_wait()
+{
+    Lock_guard <Spinlock> guard { lock };
+
+    for (Block *b; (b = waitlist.dequeue()); coalesce (b)) ;
+}
+
+/*
+ * Retain a memory region until the next TLB synchronization
+ *
+ * @param ptr       Memory region (must be unmapped from the address space)
+ */
+void Buddy::Retainlist::enqueue (void *ptr)
+{
+    auto const idx { page_to_index (reinterpret_cast<uintptr_t>(ptr)) };
+
+    // Ensure memory is within allocator range
+    assert (valid (idx));
+
+    Lock_guard <Spinlock> guard { lock };
+
+    list.enqueue_head (index_to_block (idx));
+}
+
+/*
+ * Move all retained memory regions to the waitlist of the current core
+ *
+ * Must be called before the TLB synchronization that the regions wait for.
+ */
+void Buddy::Retainlist::wait()
+{
+    Lock_guard <Spinlock> guard { lock };
+
+    for (Block *b; (b = list.dequeue_head()); waitlist.enqueue (b)) ;
+}
+
+/*
+ * Free all retained memory regions of an address space that is being destroyed
+ */
+void Buddy::Retainlist::free()
+{
+    Lock_guard <Spinlock> guard { lock };
+
+    for (Block *b; (b = list.dequeue_head()); Buddy::free (reinterpret_cast<void *>(index_to_page (block_to_index (b))))) ;
+}
+
+/*
+ * Determine if any memory regions are retained
+ *
+ * @return          True if there are no retained memory regions
+ */
+bool Buddy::Retainlist::empty()
+{
+    Lock_guard <Spinlock> guard { lock };
+
+    return list.empty();
+}
+
+/*
+ * Zero an order-0 block for the pre-zeroed pool of the current core
+ *
+ * Called by the idle EC, so that zero-filled allocations do not have to
+ * zero the block on the critical path.
+ *
+ * @return          True if a block was zeroed, false if there was nothing to do
+ */
+bool Buddy::prezero()
+{
+    if (EXPECT_FALSE (!Cpu::all_online() || zeroed.full() || low()))
+        return false;
+
+    if (EXPECT_FALSE (magazine[0].empty()))
+        refill (0);
+
+    auto const block { magazine[0].dequeue() };
+
+    if (EXPECT_FALSE (!block))
+        return false;
+
+    memset (reinterpret_cast<void *>(index_to_page (block_to_index (block))), 0, PAGE_SIZE);
+
+    zeroed.enqueue (block);
+
+    return true;
+}
@@ -32,9 +32,12 @@
 #include "sm.hpp"
 #include "space_hst.hpp"
 #include "space_obj.hpp"
+#include "space_pio.hpp"
 #include "stdio.hpp"
+#include "timer.hpp"
 
-INIT_PRIORITY (PRIO_SLAB) Slab_cache Ec::cache { sizeof (Ec_arch), Kobject::alignment };
+INIT_PRIORITY (PRIO_SLAB)  Slab_cache Ec::cache { sizeof (Ec_arch), Kobject::alignment, true };
+INIT_PRIORITY (PRIO_LOCAL) Ec::Proxies Ec::proxies;
 
 Atomic<Ec *>    Ec::current     { nullptr };
 Ec *            Ec::fpowner     { nullptr };
@@ -53,15 +56,22 @@ Ec *Ec::create_hst (Status &s, Pd *pd, bool t, bool fpu, cpu_t cpu, unsigned lon
     auto const hst { pd->get_hst() };
     auto const pio { pd->get_pio() };
 
-    if (EXPECT_FALSE (!obj || !hst || (Ec_arch::needs_pio && !pio))) {
+    if (EXPECT_FALSE (!obj || !hst || (Ec_arch::needs_pio && !pio) || !acquire (obj, hst, pio))) {
         s = Status::ABORTED;
         return nullptr;
     }
 
-    // FIXME: Refcount updates
+    // The page tables of the space come from the node of its first EC
+    hst->home (Numa::node_by_cpu (cpu));
+
+    // Reclaim the UTCBs of destroyed ECs, which the space retains until its next TLB synchronization
+    if (EXPECT_FALSE (!hst->retained.empty())) {
+        hst->sync();
+        Buddy::free_wait();
+    }
 
     auto const f { fpu ? new (pd->fpu_cache) Fpu : nullptr };
-    auto const u { new Utcb };
+    auto const u { new (Numa::node_by_cpu (cpu)) Utcb };
     Ec *ec;
 
     if (EXPECT_TRUE ((!fpu || f) && u && (ec = new (cache) Ec_arch (t, f, obj, hst, pio, cpu, evt, sp, hva, u))))
@@ -70,16 +80,298 @@ Ec *Ec::create_hst (Status &s, Pd *pd, bool t, bool fpu, cpu_t cpu, unsigned lon
     delete u;
     Fpu::operator delete (f, pd->fpu_cache);
 
+    if (pio)
+        pio->release();
+
+    obj->release();
+    hst->release();
+
     s = Status::MEM_OBJ;
 
     return nullptr;
 }
 
+/*
+ * Acquire the references a new EC holds to its spaces
+ *
+ * @param obj   OBJ space
+ * @param hst   HST space
+ * @param pio   PIO space (or nullptr)
+ * @return      True if successful, false if a space is going away
+ */
+bool Ec::acquire (Space_obj *obj, Space_hst *hst, Space_pio *pio)
+{
+    if (EXPECT_FALSE (!obj->add_ref()))
+        return false;
+
+    if (EXPECT_FALSE (!hst->add_ref())) {
+        obj->release();
+        return false;
+    }
+
+    if (EXPECT_FALSE (pio && !pio->add_ref())) {
+        hst->release();
+        obj->release();
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Destroy the EC and its FPU state, and release the references it held to its spaces
+ *
+ * The UTCB or vAPIC page remains mapped in the TLBs of other cores until
+ * the next TLB synchronization of the HST space, so the space retains the
+ * page until then. A vCPU also destroys its hardware state, which is no
+ * longer loaded on any core (see unload_vcpu).
+ */
+void Ec::destroy()
+{
+    auto const obj { get_obj() };
+    auto const hst { get_hst() };
+
+    // The timeout holds a reference to an SM if the EC was woken up but never resumed
+    clr_timeout();
+
+    // A kernel thread (e.g., a proxy EC) has no FPU, UTCB, or references to spaces
+    if (EXPECT_FALSE (!obj)) {
+        operator delete (this, cache);
+        return;
+    }
+
+    Fpu::operator delete (fpu, hst->get_pd()->fpu_cache);
+
+    if (is_vcpu())
+        destroy_vcpu();
+
+    if (kpage) {
+
+        uint64_t p;
+        unsigned o;
+        Memattr ma;
+
+        // Unmap the page, unless the user has replaced the mapping
+        if (hst->lookup (kva, p, o, ma) & Paging::K && p == Kmem::ptr_to_phys (kpage))
+            hst->update (kva, 0, 0, Paging::NONE, Memattr::ram());
+
+        hst->retained.enqueue (kpage);
+    }
+
+    if (auto const pio { get_pio() })
+        pio->release();
+
+    obj->release();
+    hst->release();
+
+    operator delete (this, cache);
+}
+
+/*
+ * Collect an unreferenced EC after an RCU grace period
+ *
+ * Even without references, an EC may still be used internally as an IPC
+ * partner or as the current EC of a core. Such an EC makes progress on its
+ * own and is retried later. Otherwise the EC is retired on its own core,
+ * where its timeout is queued and where it may own the FPU or have its
+ * vCPU state loaded: it stops blocking on any SM, so that no SM can wake
+ * it up anymore, releases the SCs that helped it, and is destroyed after
+ * another grace period, once no core can still be waking it up.
+ *
+ * @return      True if the EC was destroyed or handed over to its core, false if it must be retried
+ */
+bool Ec::collect()
+{
+    if (retired) {
+        destroy();
+        return true;
+    }
+
+    if (callee || caller)
+        return false;
+
+    for (cpu_t c { 0 }; c < Cpu::count; c++)
+        if (remote_current (c) == this)
+            return false;
+
+    if (Cpu::id != cpu) {
+        defer (cpu);
+        return true;
+    }
+
+    clr_timeout();
+
+    if (fpowner == this)
+        fpowner = nullptr;
+
+    if (is_vcpu())
+        unload_vcpu();
+
+    // No SM can wake the EC anymore
+    Sm::unwait (this);
+
+    if (auto const sm { blocker.load() })
+        sm->cancel (this);
+
+    // SCs that helped the EC return to their own ECs
+    unblock_sc();
+
+    retired = true;
+
+    return false;
+}
+
+/*
+ * Move the EC of a migrating SC to another core
+ *
+ * Must be called on the core of the EC. Only an EC whose sole SC is the
+ * migrating SC and that has no IPC, blocking or timeout state on the
+ * current core can move. If the EC owns the FPU, its FPU state is saved
+ * and moves with it.
+ *
+ * Other cores read the core of the EC without further synchronization.
+ * The core changes only on the old core, so a core that compares it with
+ * its own ID gets a consistent answer. Otherwise a stale value is benign:
+ * a recall hazard takes effect when the EC next returns to user mode.
+ *
+ * @param c     Target core
+ * @return      True if the EC moved, false otherwise
+ */
+bool Ec::migrate (cpu_t c)
+{
+    assert (cpu == Cpu::id);
+
+    if (subtype != Kobject::Subtype::EC_GLOBAL || callee || caller || blocked() || timeout.armed() || current == this)
+        return false;
+
+    // The host space must have a page table for the target core
+    if (EXPECT_FALSE (!get_hst()->init (c)))
+        return false;
+
+    Lock_guard <Spinlock> guard { lock };
+
+    if (scs != 1 || !empty())
+        return false;
+
+    // The current EC does not own the FPU, so it stays disabled after the state is saved
+    if (fpowner == this) {
+        switch_fpu (nullptr);
+        Fpu::disable();
+    }
+
+    cpu = c;
+
+    return true;
+}
+
 void Ec::create_idle()
 {
     Status s;
     current = Ec::create (Cpu::id, idle);
-    Scheduler::set_current (Pd::create_sc (s, &Space_obj::nova, Space_obj::Selector::NOVA_CPU + Cpu::id, current, Cpu::id, 1000, 0, 0));
+    Scheduler::set_current (Pd::create_sc (s, &Space_obj::nova, Space_obj::Selector::NOVA_CPU + Cpu::id, current, 1'000'000, 0, 0));
+}
+
+/*
+ * Create an idle proxy EC on the current core
+ *
+ * Remote calls to the core then do not need to allocate a proxy EC until
+ * more of them are in progress at the same time.
+ */
+void Ec::create_proxy()
+{
+    Status s;
+
+    auto const p { Ec::create (Cpu::id, nullptr) };
+    auto const sc { p ? Sc::create (s, p, 1'000'000, 0, 0) : nullptr };
+
+    if (EXPECT_FALSE (!sc)) {
+        if (p)
+            p->destroy();
+        return;
+    }
+
+    p->carrier = sc;
+    p->enqueue_tail (sc);
+
+    proxies.enqueue (p);
+}
+
+/*
+ * Obtain a proxy EC that performs a remote call of this EC
+ *
+ * An idle proxy EC of the core is reused if there is one. The SC of the
+ * proxy EC adopts the scheduling parameters of the SC on which this EC
+ * calls, so that the call neither gains nor loses priority on the remote
+ * core. The proxy EC holds a reference to this EC until the call is over.
+ *
+ * @param s     Status (ABORTED if this EC is being destroyed, MEM_OBJ if out of memory)
+ * @param c     Core of the portal
+ * @return      Blocked proxy EC with its SC blocked on it (or nullptr if failed)
+ */
+Ec *Ec::get_proxy (Status &s, cpu_t c)
+{
+    auto const cur { Scheduler::get_current() };
+
+    if (EXPECT_FALSE (!add_ref())) {
+        s = Status::ABORTED;
+        return nullptr;
+    }
+
+    auto p { proxies.dequeue (c) };
+
+    if (EXPECT_TRUE (p))
+        p->carrier->adopt (cur);
+
+    else {
+
+        p = Ec::create (c, nullptr);
+
+        // The SC takes over the initial reference to the proxy EC
+        auto const sc { p ? Sc::create (s, p, cur) : nullptr };
+
+        if (EXPECT_FALSE (!sc)) {
+            if (p)
+                p->destroy();
+            release();
+            s = Status::MEM_OBJ;
+            return nullptr;
+        }
+
+        p->carrier = sc;
+        p->enqueue_tail (sc);
+    }
+
+    p->client = this;
+    p->issued = Timer::time();
+
+    return p;
+}
+
+/*
+ * Enqueue an idle proxy EC on the current core
+ *
+ * @param p     Proxy EC (blocked, with its SC blocked on it)
+ */
+void Ec::Proxies::enqueue (Ec *p)
+{
+    Lock_guard <Spinlock> guard { lock };
+
+    queue.enqueue_tail (p);
+}
+
+/*
+ * Dequeue an idle proxy EC of a core
+ *
+ * @param c     Core
+ * @return      Proxy EC (or nullptr if none)
+ */
+Ec *Ec::Proxies::dequeue (cpu_t c)
+{
+    auto const r { Kmem::loc_to_glob (this, c) };
+
+    Lock_guard <Spinlock> guard { r->lock };
+
+    return r->queue.dequeue_head();
 }
 
 void Ec::create_root()
@@ -107,7 +399,7 @@ void Ec::create_root()
     auto utcb_addr { (Space_hst::selectors() - 2) << PAGE_BITS };
 
     auto const ec { Pd::create_ec (s, obj, Space_obj::selectors - 4, Pd::root, Cpu::id, 0, 0, utcb_addr, BIT (2) | BIT (1)) };
-    auto const sc { Pd::create_sc (s, obj, Space_obj::selectors - 5, ec, Cpu::id, 1000, Scheduler::priorities - 1, 0) };
+    auto const sc { Pd::create_sc (s, obj, Space_obj::selectors - 5, ec, 1'000'000, Scheduler::priorities - 1, 0) };
 
     if (EXPECT_FALSE (!ec || !sc))
         return;
@@ -210,7 +502,17 @@ void Ec::idle (Ec *const self)
         if (EXPECT_FALSE (hzd))
             self->handle_hazard (hzd, idle);
 
-        Cpu::halt();
+        // Return retained empty slabs under memory pressure
+        if (EXPECT_FALSE (Buddy::low()))
+            Slab_cache::reclaim();
+
+        // Use idle time to refill the pre-zeroed page pool before halting
+        if (Buddy::prezero())
+            Cpu::preemption_point();
+        else {
+            Scheduler::steal();
+            Cpu::halt();
+        }
     }
 }
 
@@ -220,8 +522,14 @@ void Ec::kill (char const *reason)
 
     auto const ec { caller };
 
-    if (ec)
-        ec->cont = ec->cont == Ec_arch::ret_user_hypercall ? sys_finish<Status::ABORTED> : dead;
+    if (ec) {
+
+        // A proxy EC resumes its remote caller instead of dying
+        if (ec->client)
+            ec->cont = finish_remote<sys_finish<Status::ABORTED>>;
+        else
+            ec->cont = ec->cont == Ec_arch::ret_user_hypercall ? sys_finish<Status::ABORTED> : dead;
+    }
 
     reply (dead);
 }
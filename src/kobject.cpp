@@ -0,0 +1,98 @@
+/*
+ * Kernel Object
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "ec.hpp"
+#include "pt.hpp"
+#include "scg.hpp"
+#include "sm.hpp"
+#include "space_dma.hpp"
+#include "space_gst.hpp"
+#include "space_hst.hpp"
+#include "space_msr.hpp"
+#include "space_obj.hpp"
+#include "space_pio.hpp"
+
+/*
+ * Drop a reference to this kernel object
+ *
+ * When the last reference is gone, the object can no longer be found via
+ * capabilities or its PD, but lock-free lookups on other cores may still
+ * be using it. It is therefore destroyed only after an RCU grace period.
+ */
+void Kobject::release()
+{
+    if (EXPECT_TRUE (!del_ref()))
+        return;
+
+    // Prevent the PD from handing out an attached space that is going away
+    if (type == Type::PD && subtype != Subtype::PD) {
+
+        auto const pd { static_cast<Space *>(this)->get_pd() };
+
+        if (pd)
+            pd->unpublish (static_cast<Space *>(this));
+    }
+
+    defer();
+}
+
+/*
+ * Destroy an unreferenced kernel object after an RCU grace period
+ *
+ * @param e     RCU element of the kernel object
+ */
+void Kobject::free (Rcu_elem *e)
+{
+    auto const k { static_cast<Kobject *>(e) };
+
+    switch (k->type) {
+
+        case Type::PD:
+            switch (k->subtype) {
+                case Subtype::PD:  static_cast<Pd *>(k)->destroy(); break;
+                case Subtype::OBJ: static_cast<Space_obj *>(k)->get_pd()->destroy (static_cast<Space_obj *>(k)); break;
+                case Subtype::HST: static_cast<Space_hst *>(k)->get_pd()->destroy (static_cast<Space_hst *>(k)); break;
+                case Subtype::GST: static_cast<Space_gst *>(k)->get_pd()->destroy (static_cast<Space_gst *>(k)); break;
+                case Subtype::DMA: static_cast<Space_dma *>(k)->get_pd()->destroy (static_cast<Space_dma *>(k)); break;
+                case Subtype::PIO: static_cast<Space_pio *>(k)->get_pd()->destroy (static_cast<Space_pio *>(k)); break;
+                case Subtype::MSR: static_cast<Space_msr *>(k)->get_pd()->destroy (static_cast<Space_msr *>(k)); break;
+                default: break;
+            }
+            break;
+
+        case Type::EC:
+            // An EC that is still in use internally is retried after another grace period
+            if (!static_cast<Ec *>(k)->collect())
+                k->defer();
+            break;
+
+        case Type::SC:
+            if (k->subtype == Subtype::SC_SCHED)
+                static_cast<Sc *>(k)->collect();
+            else
+                static_cast<Scg *>(k)->destroy();
+            break;
+
+        case Type::PT:
+            static_cast<Pt *>(k)->destroy();
+            break;
+
+        case Type::SM:
+            static_cast<Sm *>(k)->collect();
+            break;
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * Non-Uniform Memory Access (NUMA)
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "numa.hpp"
+#include "stdio.hpp"
+
+Numa::node_t Numa::node;
+
+/*
+ * Map a proximity domain to a node, allocating a new node if necessary
+ *
+ * Proximity domains beyond the supported number of nodes fold into node 0.
+ *
+ * @param p         Proximity domain
+ * @return          Node
+ */
+Numa::node_t Numa::pxm_to_node (uint32_t p)
+{
+    for (node_t n { 0 }; n < count; n++)
+        if (pxm[n] == p)
+            return n;
+
+    // The first proximity domain claims node 0
+    if (!mem_count && !cpu_count) {
+        pxm[0] = p;
+        return 0;
+    }
+
+    if (EXPECT_FALSE (count == nodes))
+        return 0;
+
+    pxm[count] = p;
+
+    return count++;
+}
+
+/*
+ * Record the affinity of a memory range
+ *
+ * @param b         Physical base address
+ * @param s         Size
+ * @param p         Proximity domain
+ */
+void Numa::add_mem (uint64_t b, uint64_t s, uint32_t p)
+{
+    auto const n { pxm_to_node (p) };
+
+    if (EXPECT_FALSE (mem_count == max_mem))
+        return;
+
+    mem[mem_count++] = { b, s, n };
+
+    trace (TRACE_FIRM | TRACE_PARSE, "NUMA: MEM %#018lx-%#018lx Node %u (PXM %u)", b, b + s, n, p);
+}
+
+/*
+ * Record the affinity of a processor
+ *
+ * @param t         Processor topology
+ * @param p         Proximity domain
+ */
+void Numa::add_cpu (uint32_t t, uint32_t p)
+{
+    auto const n { pxm_to_node (p) };
+
+    if (EXPECT_FALSE (cpu_count == max_cpu))
+        return;
+
+    cpu[cpu_count++] = { t, n };
+
+    trace (TRACE_FIRM | TRACE_PARSE, "NUMA: CPU %#x Node %u (PXM %u)", t, n, p);
+}
+
+/*
+ * Determine the node of a physical address
+ *
+ * @param p         Physical address
+ * @return          Node (0 if unknown)
+ */
+Numa::node_t Numa::node_by_phys (uint64_t p)
+{
+    for (unsigned i { 0 }; i < mem_count; i++)
+        if (p - mem[i].base < mem[i].size)
+            return mem[i].node;
+
+    return 0;
+}
+
+/*
+ * Determine the node of a processor
+ *
+ * @param t         Processor topology
+ * @return          Node (0 if unknown)
+ */
+Numa::node_t Numa::node_by_topology (uint32_t t)
+{
+    for (unsigned i { 0 }; i < cpu_count; i++)
+        if (cpu[i].topology == t)
+            return cpu[i].node;
+
+    return 0;
+}
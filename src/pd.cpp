@@ -22,6 +22,7 @@
 #include "ec_arch.hpp"
 #include "fpu.hpp"
 #include "pt.hpp"
+#include "scg.hpp"
 #include "sm.hpp"
 #include "space_dma.hpp"
 #include "space_gst.hpp"
@@ -31,7 +32,7 @@
 #include "space_pio.hpp"
 #include "stdio.hpp"
 
-INIT_PRIORITY (PRIO_SLAB) Slab_cache Pd::cache { sizeof (Pd), Kobject::alignment };
+INIT_PRIORITY (PRIO_SLAB) Slab_cache Pd::cache { sizeof (Pd), Kobject::alignment, true };
 
 Pd::Pd() : Kobject (Kobject::Type::PD),
            dma_cache (sizeof (Space_dma), Kobject::alignment),
@@ -47,50 +48,82 @@ Pd::Pd() : Kobject (Kobject::Type::PD),
 
 Space_obj *Pd::create_obj (Status &s, Space_obj *obj, unsigned long sel)
 {
-    if (EXPECT_FALSE (!attach (Kobject::Subtype::OBJ))) {
+    // The space holds a reference to its PD
+    if (EXPECT_FALSE (!add_ref())) {
         s = Status::ABORTED;
         return nullptr;
     }
 
-    auto const o { Space_obj::create (s, obj_cache, this) };
+    if (EXPECT_TRUE (attach (Kobject::Subtype::OBJ))) {
 
-    if (EXPECT_TRUE (o)) {
+        auto const o { Space_obj::create (s, obj_cache, this) };
 
-        if (EXPECT_TRUE ((s = obj->insert (sel, Capability (o, std::to_underlying (Capability::Perm_sp::DEFINED_OBJ)))) == Status::SUCCESS))
-            return space_obj = o;
+        if (EXPECT_TRUE (o)) {
 
-        o->destroy (obj_cache);
-    }
+            // Publish the space before its capability can be revoked
+            space_obj = o;
+
+            if (EXPECT_TRUE ((s = obj->insert (sel, Capability (o, std::to_underlying (Capability::Perm_sp::DEFINED_OBJ)))) == Status::SUCCESS))
+                return o;
+
+            space_obj = nullptr;
+
+            o->destroy (obj_cache);
+        }
+
+        detach (Kobject::Subtype::OBJ);
+
+    } else
+        s = Status::ABORTED;
 
-    detach (Kobject::Subtype::OBJ);
+    release();
 
     return nullptr;
 }
 
 Space_hst *Pd::create_hst (Status &s, Space_obj *obj, unsigned long sel)
 {
-    if (EXPECT_FALSE (!attach (Kobject::Subtype::HST))) {
+    // The space holds a reference to its PD
+    if (EXPECT_FALSE (!add_ref())) {
         s = Status::ABORTED;
         return nullptr;
     }
 
-    auto const o { Space_hst::create (s, hst_cache, this) };
+    if (EXPECT_TRUE (attach (Kobject::Subtype::HST))) {
 
-    if (EXPECT_TRUE (o)) {
+        auto const o { Space_hst::create (s, hst_cache, this) };
 
-        if (EXPECT_TRUE ((s = obj->insert (sel, Capability (o, std::to_underlying (Capability::Perm_sp::DEFINED_HST)))) == Status::SUCCESS))
-            return space_hst = o;
+        if (EXPECT_TRUE (o)) {
 
-        o->destroy (hst_cache);
-    }
+            // Publish the space before its capability can be revoked
+            space_hst = o;
+
+            if (EXPECT_TRUE ((s = obj->insert (sel, Capability (o, std::to_underlying (Capability::Perm_sp::DEFINED_HST)))) == Status::SUCCESS))
+                return o;
+
+            space_hst = nullptr;
+
+            o->destroy (hst_cache);
+        }
+
+        detach (Kobject::Subtype::HST);
+
+    } else
+        s = Status::ABORTED;
 
-    detach (Kobject::Subtype::HST);
+    release();
 
     return nullptr;
 }
 
 Space_gst *Pd::create_gst (Status &s, Space_obj *obj, unsigned long sel)
 {
+    // The space holds a reference to its PD
+    if (EXPECT_FALSE (!add_ref())) {
+        s = Status::ABORTED;
+        return nullptr;
+    }
+
     auto const o { Space_gst::create (s, gst_cache, this) };
 
     if (EXPECT_TRUE (o)) {
@@ -101,11 +134,19 @@ Space_gst *Pd::create_gst (Status &s, Space_obj *obj, unsigned long sel)
         o->destroy (gst_cache);
     }
 
+    release();
+
     return nullptr;
 }
 
 Space_dma *Pd::create_dma (Status &s, Space_obj *obj, unsigned long sel)
 {
+    // The space holds a reference to its PD
+    if (EXPECT_FALSE (!add_ref())) {
+        s = Status::ABORTED;
+        return nullptr;
+    }
+
     auto const o { Space_dma::create (s, dma_cache, this) };
 
     if (EXPECT_TRUE (o)) {
@@ -116,19 +157,34 @@ Space_dma *Pd::create_dma (Status &s, Space_obj *obj, unsigned long sel)
         o->destroy (dma_cache);
     }
 
+    release();
+
     return nullptr;
 }
 
 Space_pio *Pd::create_pio (Status &s, Space_obj *obj, unsigned long sel)
 {
+    // The space holds a reference to its PD
+    if (EXPECT_FALSE (!add_ref())) {
+        s = Status::ABORTED;
+        return nullptr;
+    }
+
     auto const a { attach (Kobject::Subtype::PIO) };
 
     auto const o { Space_pio::create (s, pio_cache, this, a) };
 
     if (EXPECT_TRUE (o)) {
 
+        // Publish the space before its capability can be revoked
+        if (a)
+            space_pio = o;
+
         if (EXPECT_TRUE ((s = obj->insert (sel, Capability (o, std::to_underlying (Capability::Perm_sp::DEFINED_PIO)))) == Status::SUCCESS))
-            return a ? space_pio = o : o;
+            return o;
+
+        if (a)
+            space_pio = nullptr;
 
         o->destroy (pio_cache);
     }
@@ -136,11 +192,19 @@ Space_pio *Pd::create_pio (Status &s, Space_obj *obj, unsigned long sel)
     if (a)
         detach (Kobject::Subtype::PIO);
 
+    release();
+
     return nullptr;
 }
 
 Space_msr *Pd::create_msr (Status &s, Space_obj *obj, unsigned long sel)
 {
+    // The space holds a reference to its PD
+    if (EXPECT_FALSE (!add_ref())) {
+        s = Status::ABORTED;
+        return nullptr;
+    }
+
     auto const o { Space_msr::create (s, msr_cache, this) };
 
     if (EXPECT_TRUE (o)) {
@@ -151,9 +215,91 @@ Space_msr *Pd::create_msr (Status &s, Space_obj *obj, unsigned long sel)
         o->destroy (msr_cache);
     }
 
+    release();
+
     return nullptr;
 }
 
+/*
+ * Destroy an OBJ space of this PD
+ *
+ * Releases all capabilities in the space and the reference the space held to this PD.
+ *
+ * @param o     OBJ space (must be unreferenced and past its RCU grace period)
+ */
+void Pd::destroy (Space_obj *o)
+{
+    o->destroy (obj_cache);
+
+    release();
+}
+
+/*
+ * Destroy a memory, I/O port or MSR space of this PD
+ *
+ * Frees the page tables or bitmaps of the space and releases the reference
+ * the space held to this PD.
+ *
+ * @param o     Space (must be unreferenced and past its RCU grace period)
+ */
+void Pd::destroy (Space_hst *o)
+{
+    o->destroy (hst_cache);
+
+    release();
+}
+
+void Pd::destroy (Space_gst *o)
+{
+    o->destroy (gst_cache);
+
+    release();
+}
+
+void Pd::destroy (Space_dma *o)
+{
+    o->destroy (dma_cache);
+
+    release();
+}
+
+void Pd::destroy (Space_pio *o)
+{
+    o->destroy (pio_cache);
+
+    release();
+}
+
+void Pd::destroy (Space_msr *o)
+{
+    o->destroy (msr_cache);
+
+    release();
+}
+
+/*
+ * Stop handing out an attached space whose last reference is gone
+ *
+ * @param s     Space
+ */
+void Pd::unpublish (Space const *s)
+{
+    if (s == space_obj.load()) {
+        space_obj = nullptr;
+        detach (Kobject::Subtype::OBJ);
+    }
+
+    if (s == space_hst.load()) {
+        space_hst = nullptr;
+        detach (Kobject::Subtype::HST);
+    }
+
+    if (s == space_pio.load()) {
+        space_pio = nullptr;
+        detach (Kobject::Subtype::PIO);
+    }
+}
+
 Pd *Pd::create_pd (Status &s, Space_obj *obj, unsigned long sel, unsigned prm)
 {
     auto const o { Pd::create (s) };
@@ -184,9 +330,40 @@ Ec *Pd::create_ec (Status &s, Space_obj *obj, unsigned long sel, Pd *pd, cpu_t c
     return nullptr;
 }
 
-Sc *Pd::create_sc (Status &s, Space_obj *obj, unsigned long sel, Ec *ec, cpu_t cpu, uint16_t budget, uint8_t prio, uint16_t cos)
+Sc *Pd::create_sc (Status &s, Space_obj *obj, unsigned long sel, Ec *ec, uint32_t budget, uint8_t prio, uint16_t cos, bool mig, uint32_t period, uint32_t deadline)
+{
+    // The SC holds a reference to its EC
+    if (EXPECT_FALSE (!ec->add_ref())) {
+        s = Status::ABORTED;
+        return nullptr;
+    }
+
+    auto const o { Sc::create (s, ec, budget, prio, cos, mig, period, deadline) };
+
+    if (EXPECT_TRUE (o)) {
+
+        if (EXPECT_TRUE ((s = obj->insert (sel, Capability (o, std::to_underlying (Capability::Perm_sc::DEFINED)))) == Status::SUCCESS))
+            return o;
+
+        o->destroy();
+
+        return nullptr;
+    }
+
+    ec->release();
+
+    return nullptr;
+}
+
+Scg *Pd::create_scg (Status &s, Space_obj *obj, unsigned long sel, Scg *parent, cpu_t cpu, uint32_t budget, uint32_t period)
 {
-    auto const o { Sc::create (s, cpu, ec, budget, prio, cos) };
+    // The group holds a reference to its parent
+    if (EXPECT_FALSE (parent && !parent->add_ref())) {
+        s = Status::ABORTED;
+        return nullptr;
+    }
+
+    auto const o { Scg::create (s, parent, cpu, budget, period) };
 
     if (EXPECT_TRUE (o)) {
 
@@ -194,13 +371,24 @@ Sc *Pd::create_sc (Status &s, Space_obj *obj, unsigned long sel, Ec *ec, cpu_t c
             return o;
 
         o->destroy();
+
+        return nullptr;
     }
 
+    if (parent)
+        parent->release();
+
     return nullptr;
 }
 
 Pt *Pd::create_pt (Status &s, Space_obj *obj, unsigned long sel, Ec *ec, uintptr_t ip)
 {
+    // The PT holds a reference to its EC
+    if (EXPECT_FALSE (!ec->add_ref())) {
+        s = Status::ABORTED;
+        return nullptr;
+    }
+
     auto const o { Pt::create (s, ec, ip) };
 
     if (EXPECT_TRUE (o)) {
@@ -209,14 +397,18 @@ Pt *Pd::create_pt (Status &s, Space_obj *obj, unsigned long sel, Ec *ec, uintptr
             return o;
 
         o->destroy();
+
+        return nullptr;
     }
 
+    ec->release();
+
     return nullptr;
 }
 
-Sm *Pd::create_sm (Status &s, Space_obj *obj, unsigned long sel, uint64_t ct, unsigned id)
+Sm *Pd::create_sm (Status &s, Space_obj *obj, unsigned long sel, uint64_t ct, unsigned id, Kobject::Subtype st)
 {
-    auto const o { Sm::create (s, ct, id) };
+    auto const o { Sm::create (s, ct, id, st) };
 
     if (EXPECT_TRUE (o)) {
 
@@ -23,9 +23,19 @@
 #include "pt.hpp"
 #include "stdio.hpp"
 
-INIT_PRIORITY (PRIO_SLAB) Slab_cache Pt::cache { sizeof (Pt), Kobject::alignment };
+INIT_PRIORITY (PRIO_SLAB) Slab_cache Pt::cache { sizeof (Pt), Kobject::alignment, true };
 
 Pt::Pt (Ec *e, uintptr_t i) : Kobject (Kobject::Type::PT), ec (e), ip (i)
 {
     trace (TRACE_CREATE, "PT:%p created (EC:%p IP:%#lx)", static_cast<void *>(this), static_cast<void *>(e), ip);
 }
+
+/*
+ * Destroy the PT and release the reference it held to its EC
+ */
+void Pt::destroy()
+{
+    ec->release();
+
+    operator delete (this, cache);
+}
@@ -60,10 +60,11 @@
  * @param v     Virtual address whose PTE is being looked up
  * @param t     Target level to walk down to
  * @param e     True if making entries, false if making holes
+ * @param node  Preferred NUMA node for new page tables
  * @return      Pointer to the PTE (if exists) or ~0 (skippable hole) or nullptr (allocation failure)
  */
 template <typename T, typename I, typename O>
-typename Ptab<T,I,O>::PTE *Ptab<T,I,O>::walk (IAddr v, unsigned t, bool e)
+typename Ptab<T,I,O>::PTE *Ptab<T,I,O>::walk (IAddr v, unsigned t, bool e, Numa::node_t node)
 {
     auto l { T::lev() }; T pte;
 
@@ -93,7 +94,7 @@ typename Ptab<T,I,O>::PTE *Ptab<T,I,O>::walk (IAddr v, unsigned t, bool e)
                 OAddr const s { (type == Entry::Type::LEAF) * T::page_size (n * T::bpl) };
 
                 // Allocate a new page table
-                auto const ptab { new (T::lev_bit (n) - T::bpl) Ptab (T::lev_ent (n), p, s) };
+                auto const ptab { new (T::lev_bit (n) - T::bpl, node) Ptab (T::lev_ent (n), p, s) };
 
                 // Terminate the walk if allocation failed
                 if (EXPECT_FALSE (!ptab))
@@ -176,10 +177,11 @@ Paging::Permissions Ptab<T,I,O>::lookup (IAddr v, OAddr &p, unsigned &o, Memattr
  * @param ord   Page order (2^ord pages) of the range
  * @param pm    Page permissions (0 for zapping PTEs)
  * @param ma    Memory attributes
+ * @param node  Preferred NUMA node for new page tables
  * @return      SUCCESS (successful) or MEM_CAP (allocation failure)
  */
 template <typename T, typename I, typename O>
-Status Ptab<T,I,O>::update (IAddr v, OAddr p, unsigned ord, Paging::Permissions pm, Memattr ma)
+Status Ptab<T,I,O>::update (IAddr v, OAddr p, unsigned ord, Paging::Permissions pm, Memattr ma, Numa::node_t node)
 {
     // Both virtual and physical address must be order-aligned
     assert ((v & T::offs_mask (ord)) == 0);
@@ -194,7 +196,7 @@ Status Ptab<T,I,O>::update (IAddr v, OAddr p, unsigned ord, Paging::Permissions
     for (unsigned i { 0 }; i < BITN (ord - o); i++, v += BITN (o + PAGE_BITS), p += BITN (o + PAGE_BITS)) {
 
         // Get pointer to the first PTE
-        auto const ptr { walk (v, l, a) };
+        auto const ptr { walk (v, l, a, node) };
 
         // Allocation failure
         if (EXPECT_FALSE (!ptr))
@@ -255,3 +257,62 @@ void Ptab<T,I,O>::deallocate (unsigned l)
 
     operator delete (this, true);
 }
+
+/*
+ * Destroy a page table subtree, including the page tables of the leaf level
+ *
+ * Unlike deallocate, the tables are freed immediately, because the
+ * address space is unreferenced and no TLB can use them anymore.
+ *
+ * @param l     Subtree level
+ */
+template <typename T, typename I, typename O>
+void Ptab<T,I,O>::destroy (unsigned l)
+{
+    if (l)
+        for (unsigned i { 0 }; i < T::lev_ent (l); i++) {
+
+            auto const old { static_cast<T>(this[i].entry) };
+
+            if (old.type (l) == Entry::Type::PTAB)
+                old->destroy (l - 1);
+        }
+
+    operator delete (this, false);
+}
+
+/*
+ * Destroy all page tables of an unreferenced address space
+ */
+template <typename T, typename I, typename O>
+void Ptab<T,I,O>::root_fini()
+{
+    auto const pte { static_cast<T>(entry) };
+
+    if (pte.type (T::lev()) == Entry::Type::PTAB)
+        pte->destroy (T::lev() - 1);
+}
+
+/*
+ * Destroy the page tables of an unreferenced address space whose other page tables are shared
+ *
+ * Only the tables on the path to the specified address are freed, from
+ * the root down to and including the target level.
+ *
+ * @param v     Virtual address that selects the path
+ * @param t     Target level
+ */
+template <typename T, typename I, typename O>
+void Ptab<T,I,O>::root_fini (IAddr v, unsigned t)
+{
+    auto pte { static_cast<T>(entry) };
+
+    for (auto l { T::lev() }; l > t && pte.type (l) == Entry::Type::PTAB; l--) {
+
+        auto const ptab { pte.operator->() };
+
+        pte = static_cast<T>(ptab[T::lev_idx (l - 1, v)].entry);
+
+        operator delete (ptab, false);
+    }
+}
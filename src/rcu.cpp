@@ -24,6 +24,7 @@
 #include "cpu.hpp"
 #include "hazard.hpp"
 #include "initprio.hpp"
+#include "kmem.hpp"
 #include "rcu.hpp"
 #include "stdio.hpp"
 
@@ -36,11 +37,28 @@ INIT_PRIORITY (PRIO_LOCAL) Rcu_list Rcu::next;
 INIT_PRIORITY (PRIO_LOCAL) Rcu_list Rcu::curr;
 INIT_PRIORITY (PRIO_LOCAL) Rcu_list Rcu::done;
 
+Rcu_elem *  Rcu::xfer;
+
+/*
+ * Hand an element over to another core, which invokes its callback after a grace period
+ *
+ * @param e     RCU element
+ * @param c     Core that invokes the callback
+ */
+void Rcu::call (Rcu_elem *e, cpu_t c)
+{
+    auto const x { Kmem::loc_to_glob (&xfer, c) };
+
+    e->next = __atomic_load_n (x, __ATOMIC_RELAXED);
+
+    while (!__atomic_compare_exchange_n (x, &e->next, e, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) ;
+}
+
 void Rcu::invoke_batch()
 {
     for (Rcu_elem *e = done.head, *n; e; e = n) {
         n = e->next;
-        (e->func)(e);
+        (e->callback)(e);
     }
 
     done.clear();
@@ -72,6 +90,11 @@ void Rcu::quiet()
 
 void Rcu::update()
 {
+    for (Rcu_elem *e { __atomic_exchange_n (&xfer, nullptr, __ATOMIC_ACQUIRE) }, *n; e; e = n) {
+        n = e->next;
+        next.enqueue (e);
+    }
+
     if (l_batch != batch()) {
         l_batch = batch();
         Cpu::hazard |= Hazard::RCU;
@@ -21,23 +21,96 @@
  */
 
 #include "assert.hpp"
+#include "bits.hpp"
 #include "cos.hpp"
 #include "counter.hpp"
 #include "ec.hpp"
 #include "interrupt.hpp"
+#include "lowlevel.hpp"
+#include "scg.hpp"
 #include "stdio.hpp"
 #include "timeout_budget.hpp"
 #include "timer.hpp"
 
-INIT_PRIORITY (PRIO_SLAB)   Slab_cache Sc::cache { sizeof (Sc), Kobject::alignment };
+INIT_PRIORITY (PRIO_SLAB)   Slab_cache Sc::cache { sizeof (Sc), Kobject::alignment, true };
 INIT_PRIORITY (PRIO_LOCAL)  Scheduler::Ready    Scheduler::ready;
 INIT_PRIORITY (PRIO_LOCAL)  Scheduler::Release  Scheduler::release;
 
 Sc *Scheduler::current { nullptr };
+Atomic<unsigned> Scheduler::thief { 0 };
+Atomic<unsigned> Scheduler::misses { 0 };
+uint64_t Scheduler::retry { 0 };
 
-Sc::Sc (cpu_t n, Ec *e, uint16_t b, uint8_t p, uint16_t c) : Kobject (Kobject::Type::SC), ec (e), budget (Stc::ms_to_ticks (b)), cpu (n), cos (c), prio (p)
+Sc::Sc (Ec *e, uint32_t b, uint8_t p, uint16_t c, bool m, uint32_t t, uint32_t d) : Kobject (Kobject::Type::SC, Kobject::Subtype::SC_SCHED), ec (e), budget (Stc::us_to_ticks (b)), cpu (e->bind_sc()), cos (c), prio (p), migratable (m), period (Stc::us_to_ticks (t)), relative (Stc::us_to_ticks (d)), deadline (t ? 0 : ~0ULL)
 {
-    trace (TRACE_CREATE, "SC:%p created (EC:%p CPU:%u Budget:%ums Prio:%u COS:%u)", static_cast<void *>(this), static_cast<void *>(ec), cpu, b, p, c);
+    trace (TRACE_CREATE, "SC:%p created (EC:%p CPU:%u Budget:%uus Prio:%u COS:%u%s Period:%uus Deadline:%uus)", static_cast<void *>(this), static_cast<void *>(ec), cpu, b, p, c, m ? " MIG" : "", t, d);
+}
+
+Sc::Sc (Ec *e, Sc const *sc) : Kobject (Kobject::Type::SC, Kobject::Subtype::SC_SCHED), ec (e), budget (sc->budget), cpu (e->bind_sc()), cos (sc->cos), prio (sc->prio), period (sc->period), relative (sc->relative), deadline (sc->period ? 0 : ~0ULL)
+{
+    trace (TRACE_CREATE, "SC:%p created (EC:%p CPU:%u SC:%p)", static_cast<void *>(this), static_cast<void *>(ec), cpu, static_cast<void const *>(sc));
+}
+
+/*
+ * Destroy the SC and release the references it held to its EC and group
+ */
+void Sc::destroy()
+{
+    if (group)
+        group->release();
+
+    ec->unbind_sc();
+    ec->release();
+
+    operator delete (this, cache);
+}
+
+/*
+ * Collect an unreferenced SC after an RCU grace period
+ *
+ * The SC may still be current, queued in the scheduler, or blocked on an EC.
+ * The first grace period therefore only retires the SC. The scheduler of its
+ * core drops a retired SC instead of running it and defers it again, so that
+ * the SC is destroyed after the second grace period. An SC that is blocked
+ * on an EC might never reach the scheduler again and is therefore removed
+ * from the EC and deferred right away.
+ */
+void Sc::collect()
+{
+    if (retired)
+        destroy();
+
+    else {
+
+        retired = true;
+
+        if (ec->remove_sc (this))
+            defer();
+    }
+}
+
+/*
+ * Make the SC a member of a quota group
+ *
+ * The SC must be on the core of the group and cannot migrate. An SC can
+ * join only one group, which it remains a member of until it is destroyed.
+ *
+ * @param g     Group
+ * @return      True if successful, false otherwise
+ */
+bool Sc::join (Scg *g)
+{
+    if (EXPECT_FALSE (migratable || g->get_cpu() != cpu || !g->add_ref()))
+        return false;
+
+    Scg *o { nullptr };
+
+    if (EXPECT_TRUE (group.compare_exchange (o, g)))
+        return true;
+
+    g->release();
+
+    return false;
 }
 
 void Scheduler::Ready::enqueue (Sc *sc, uint64_t t)
@@ -45,12 +118,38 @@ void Scheduler::Ready::enqueue (Sc *sc, uint64_t t)
     assert (sc->cpu == Cpu::id);
     assert (sc->prio < priorities);
 
+    if (sc->period) {
+
+        // An exhausted EDF SC is throttled until its budget is replenished at its deadline
+        if (!sc->left && t < sc->deadline) {
+            sc->replenish.enqueue (sc->deadline);
+            return;
+        }
+
+        // A waking EDF SC gets a new deadline, unless its remaining budget fits into its bandwidth until the current deadline (products of ticks need 128 bits)
+        if (!sc->left || (sc != current && (t >= sc->deadline || static_cast<__uint128_t>(sc->left) * sc->period > static_cast<__uint128_t>(sc->deadline - t) * sc->budget))) {
+            sc->left     = sc->budget;
+            sc->deadline = t + sc->relative;
+        }
+    }
+
     if (sc->prio > prio_top)
         prio_top = sc->prio;
 
-    queue[sc->prio].enqueue (sc, sc->left);
+    // EDF SCs are sorted by deadline ahead of all round-robin SCs, which go to the tail or, with budget left, ahead of the other round-robin SCs
+    auto const empty { sc->period ? queue[sc->prio].enqueue_sorted (sc, [] (Sc const *a, Sc const *b) { return a->precedes (b); }) :
+                       sc->left   ? queue[sc->prio].enqueue_sorted (sc, [] (Sc const *, Sc const *b) { return !b->period; }) :
+                                    queue[sc->prio].enqueue_tail (sc) };
 
-    if (sc->prio > current->prio || (sc != current && sc->prio == current->prio && sc->left))
+    if (empty) {
+        prio_map[sc->prio / bpw] |= BITN (sc->prio % bpw);
+        prio_sum                 |= BITN (sc->prio / bpw);
+    }
+
+    if (sc->migratable)
+        movable++;
+
+    if (sc->prio > current->prio || (sc != current && sc->prio == current->prio && (sc->precedes (current) || (sc->left && !current->period))))
         Cpu::hazard |= Hazard::SCHED;
 
     if (!sc->left)
@@ -67,8 +166,11 @@ auto Scheduler::Ready::dequeue (uint64_t t)
     assert (sc->cpu == Cpu::id);
     assert (sc->prio < priorities);
 
-    while (queue[prio_top].empty() && prio_top)
-        prio_top--;
+    if (queue[prio_top].empty())
+        clear (prio_top);
+
+    if (sc->migratable)
+        movable--;
 
     if (EXPECT_TRUE (sc->ec != current->ec))
         sc->ec->adjust_offset_ticks (t - sc->last);
@@ -78,26 +180,104 @@ auto Scheduler::Ready::dequeue (uint64_t t)
     return sc;
 }
 
-void Scheduler::Release::enqueue (Sc *sc)
+/*
+ * Mark a priority as empty and find the next non-empty priority via the bitmaps in constant time
+ *
+ * @param p     Priority whose queue has become empty
+ */
+void Scheduler::Ready::clear (unsigned p)
 {
-    auto const r { Kmem::loc_to_glob (this, sc->cpu) };
+    if (!(prio_map[p / bpw] &= ~BITN (p % bpw)))
+        prio_sum &= ~BITN (p / bpw);
+
+    if (p != prio_top)
+        return;
+
+    auto const w { bit_scan_reverse (prio_sum) };
+
+    prio_top = w < 0 ? 0 : static_cast<unsigned>(w * bpw + bit_scan_reverse (prio_map[w]));
+}
+
+/*
+ * Remove a migratable SC from the ready queue and move it to another core
+ *
+ * Only the head of each priority is considered, which bounds the cost and
+ * favors the SC that has waited longest at the highest priority.
+ *
+ * @param c     Target core
+ * @return      Migrated SC (or nullptr if none)
+ */
+Sc *Scheduler::Ready::migrate (cpu_t c)
+{
+    for (auto p { prio_top + 1 }; p--; ) {
+
+        if (!(prio_map[p / bpw] & BITN (p % bpw)))
+            continue;
+
+        auto const sc { queue[p].dequeue_head() };
 
-    bool notify;
+        if (sc->migratable && !sc->retired && sc->ec->migrate (c)) {
 
-    {   Lock_guard <Spinlock> guard { r->lock };
+            if (queue[p].empty())
+                clear (p);
 
-        notify = r->queue.enqueue_tail (sc);
+            movable--;
+
+            sc->cpu = c;
+
+            return sc;
+        }
+
+        queue[p].enqueue_head (sc);
     }
 
-    if (notify)
+    return nullptr;
+}
+
+/*
+ * Push an SC onto the release queue of its core
+ *
+ * A producer pushes with a single atomic exchange and then links the SC to
+ * the previous head. Until then, the SC links to itself. Pushing onto an
+ * empty queue notifies the core.
+ *
+ * @param sc    SC to release
+ */
+void Scheduler::Release::enqueue (Sc *sc)
+{
+    auto const r { Kmem::loc_to_glob (this, sc->cpu) };
+
+    Sc *o;
+
+    sc->link = sc;
+    r->head.exchange (o, sc);
+    sc->link.store (o, __ATOMIC_RELEASE);
+
+    if (!o)
         Interrupt::send_cpu (Interrupt::Request::RRQ, sc->cpu);
 }
 
-auto Scheduler::Release::dequeue()
+/*
+ * Detach all SCs from the release queue
+ *
+ * @return      Detached SCs, linked in the order in which they were pushed
+ */
+Sc *Scheduler::Release::dequeue()
 {
-    Lock_guard <Spinlock> guard { lock };
+    Sc *l, *f { nullptr };
+
+    head.exchange (l, f);
+
+    // Reverse the list, waiting for producers that have not linked their SC yet
+    for (Sc *n; l; f = l, l = n) {
+
+        while ((n = l->link.load (__ATOMIC_ACQUIRE)) == l)
+            pause();
 
-    return queue.dequeue_head();
+        l->link = f;
+    }
+
+    return f;
 }
 
 void Scheduler::unblock (Sc *sc)
@@ -112,7 +292,63 @@ void Scheduler::requeue()
 {
     auto const t { Timer::time() };
 
-    for (Sc *sc; (sc = release.dequeue()); ready.enqueue (sc, t)) ;
+    for (Sc *sc { release.dequeue() }, *n; sc; sc = n) {
+        n = sc->link;
+        ready.enqueue (sc, t);
+    }
+
+    unsigned c, n { 0 };
+    thief.exchange (c, n);
+
+    // Hand a migratable SC to the idle core that requested one
+    if (c)
+        if (auto const sc { ready.migrate (static_cast<cpu_t>(c - 1)) }) {
+            *Kmem::loc_to_glob (&misses, sc->cpu) = 0;
+            release.enqueue (sc);
+        }
+}
+
+/*
+ * Request a migratable SC from a busy core
+ *
+ * Called by the idle EC before halting. Among the cores with queued
+ * migratable SCs, the topologically closest one is asked, which hands
+ * an SC over via the release queue of the current core.
+ *
+ * The busy core cannot hand over an SC whose EC is currently in IPC or
+ * blocked. Each request that remains unanswered therefore doubles the
+ * time until the next request, up to a limit.
+ */
+void Scheduler::steal()
+{
+    static constexpr unsigned backoff_us { 100 }, backoff_max { 6 };
+
+    auto const t { Timer::time() };
+
+    if (t < retry)
+        return;
+
+    cpu_t v { Cpu::id };
+
+    for (unsigned c { 0 }, d { ~0U }; c < Cpu::count; c++) {
+
+        if (c == Cpu::id || !Kmem::loc_to_glob (&ready, static_cast<cpu_t>(c))->has_movable())
+            continue;
+
+        auto const x { Cpu::distance (static_cast<cpu_t>(c)) };
+
+        if (x < d) {
+            d = x;
+            v = static_cast<cpu_t>(c);
+        }
+    }
+
+    unsigned o { 0 }, n { Cpu::id + 1U };
+
+    if (v != Cpu::id && Kmem::loc_to_glob (&thief, v)->compare_exchange (o, n)) {
+        retry = t + (Stc::us_to_ticks (backoff_us) << min (misses++, backoff_max));
+        Interrupt::send_cpu (Interrupt::Request::RRQ, v);
+    }
 }
 
 void Scheduler::schedule (bool blocked)
@@ -123,23 +359,53 @@ void Scheduler::schedule (bool blocked)
     assert (blocked || !current->queued());
 
     auto const t { Timer::time() };
-    auto const d { Timeout_budget::timeout.dequeue() };
+    auto const r { t - current->last };
+
+    Timeout_budget::timeout.dequeue();
 
-    current->used = current->used + (t - current->last);
-    current->left = d > t ? d - t : 0;
+    current->used = current->used + r;
+    current->left = current->left > r ? current->left - r : 0;
+
+    if (auto const g { current->group.load() })
+        g->charge (r, t);
 
     Cpu::hazard &= ~Hazard::SCHED;
 
-    if (EXPECT_TRUE (!blocked))
-        ready.enqueue (current, t);
+    if (EXPECT_TRUE (!blocked)) {
+        if (EXPECT_FALSE (current->retired))
+            current->defer();
+        else
+            ready.enqueue (current, t);
+    }
 
     for (;;) {
 
-        current = ready.dequeue (t);
+        auto const sc { ready.dequeue (t) };
+
+        // Drop a retired SC instead of dispatching it
+        if (EXPECT_FALSE (sc->retired)) {
+            sc->defer();
+            continue;
+        }
+
+        auto q { sc->left };
+
+        // Throttle a member of a group whose quota is exhausted
+        if (auto const g { sc->group.load() }) {
+
+            auto const l { g->admit (sc, t) };
+
+            if (!l)
+                continue;
+
+            q = min (q, l);
+        }
+
+        current = sc;
 
         Cos::make_current (current->cos);
 
-        Timeout_budget::timeout.enqueue (t + current->left);
+        Timeout_budget::timeout.enqueue (t + q);
         current->ec->activate();
         Timeout_budget::timeout.dequeue();
     }
@@ -0,0 +1,121 @@
+/*
+ * Scheduling Context Group (SCG)
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "assert.hpp"
+#include "cpu.hpp"
+#include "lock_guard.hpp"
+#include "sc.hpp"
+#include "scg.hpp"
+#include "stc.hpp"
+#include "stdio.hpp"
+
+INIT_PRIORITY (PRIO_SLAB) Slab_cache Scg::cache { sizeof (Scg), Kobject::alignment, true };
+
+Scg::Scg (Scg *g, cpu_t c, uint32_t b, uint32_t t) : Kobject (Kobject::Type::SC, Kobject::Subtype::SC_GROUP), parent (g), budget (Stc::us_to_ticks (b)), period (Stc::us_to_ticks (t)), cpu (c)
+{
+    trace (TRACE_CREATE, "SCG:%p created (Parent:%p CPU:%#x Budget:%uus Period:%uus)", static_cast<void *>(this), static_cast<void *>(g), c, b, t);
+}
+
+/*
+ * Destroy the group and release the reference it held to its parent
+ *
+ * An unreferenced group has no member SCs and thus no armed timeout.
+ */
+void Scg::destroy()
+{
+    if (parent)
+        parent->release();
+
+    operator delete (this, cache);
+}
+
+/*
+ * Determine the quota left to the group and its parent in the current period
+ *
+ * @param t     Current time
+ * @param e     Returns the time when an exhausted quota is replenished
+ * @return      Quota left
+ */
+uint64_t Scg::remaining (uint64_t t, uint64_t &e)
+{
+    uint64_t r;
+
+    {   Lock_guard <Spinlock> guard { lock };
+
+        refresh (t);
+
+        r = left;
+        e = next;
+    }
+
+    if (parent) {
+
+        uint64_t pe;
+        auto const pr { parent->remaining (t, pe) };
+
+        // If both quotas are exhausted, the later replenishment counts
+        if (pr < r || (!pr && pe > e)) {
+            r = pr;
+            e = pe;
+        }
+    }
+
+    return r;
+}
+
+/*
+ * Charge execution time of a member SC to the group and its parent
+ *
+ * @param r     Execution time
+ * @param t     Current time
+ */
+void Scg::charge (uint64_t r, uint64_t t)
+{
+    {   Lock_guard <Spinlock> guard { lock };
+
+        refresh (t);
+
+        left = left > r ? left - r : 0;
+    }
+
+    if (parent)
+        parent->charge (r, t);
+}
+
+/*
+ * Admit a member SC for dispatch
+ *
+ * If the quota of the group or its parent is exhausted, the SC is throttled
+ * until the quota is replenished. The group must be on the current core.
+ *
+ * @param sc    Member SC
+ * @param t     Current time
+ * @return      Quota left (or 0 if the SC was throttled)
+ */
+uint64_t Scg::admit (Sc *sc, uint64_t t)
+{
+    assert (cpu == Cpu::id);
+
+    uint64_t e;
+    auto const r { remaining (t, e) };
+
+    // The first throttled SC arms the timeout, which releases all of them
+    if (!r && throttled.enqueue_tail (sc))
+        timeout.enqueue (e);
+
+    return r;
+}
@@ -22,9 +22,13 @@
 #include "assert.hpp"
 #include "bits.hpp"
 #include "buddy.hpp"
+#include "counter.hpp"
+#include "cpu.hpp"
 #include "lock_guard.hpp"
 #include "slab.hpp"
 
+Slab_cache::Magazine Slab_cache::magazine[magazines];
+
 struct Slab_cache::Slab
 {
     struct Buffer
@@ -141,6 +145,7 @@ struct Slab_cache::Slab
  *
  * @param s Required element size
  * @param a Required element alignment (must be a power of 2)
+ * @param m Use per-core magazines and retain empty slabs (for hot caches with static storage duration)
  *
  * Slab Linkage Example (P:partial precede F:full)
  *
@@ -153,8 +158,72 @@ struct Slab_cache::Slab
  * !head && !curr => slab cache contains no slabs => initial state
  * !head &&  curr => illegal
  */
-Slab_cache::Slab_cache (size_t s, size_t a) : bsz (static_cast<uint16_t>(align_up (max (s, sizeof (Slab::Buffer)), max (a, alignof (Slab::Buffer))))),
-                                              bps ((PAGE_SIZE - sizeof (Slab::Metadata)) / bsz) {}
+Slab_cache::Slab_cache (size_t s, size_t a, bool m) : bsz (static_cast<uint16_t>(align_up (max (s, sizeof (Slab::Buffer)), max (a, alignof (Slab::Buffer))))),
+                                                      bps ((PAGE_SIZE - sizeof (Slab::Metadata)) / bsz),
+                                                      mag (m && mag_next < magazines ? mag_next++ : magazines),
+                                                      rmax (m ? retain : 0)
+{
+    // Register the slab cache for reclaim
+    if (rmax) {
+        next = list;
+        list = this;
+    }
+}
+
+/*
+ * Return the retained empty slabs of all slab caches to the buddy allocator
+ *
+ * Called by the idle EC when the buddy allocator is under memory pressure.
+ */
+void Slab_cache::reclaim()
+{
+    for (auto c { list }; c; c = c->next) {
+
+        Lock_guard <Spinlock> guard { c->lock };
+
+        for (Slab *s; (s = c->idle); delete s) {
+            c->idle = s->meta.next;
+            c->icnt--;
+            Counter::slab_reclaim.inc();
+        }
+    }
+
+    // Return the freed slabs from the magazines of the current core to the freelists
+    Buddy::flush();
+}
+
+/*
+ * Refill a magazine of the current core with a batch of elements
+ *
+ * @param m Magazine
+ */
+void Slab_cache::refill (Magazine &m)
+{
+    Lock_guard <Spinlock> guard { lock };
+
+    for (unsigned i { 0 }; i < Magazine::batch; i++) {
+
+        auto const p { alloc_slab() };
+
+        if (EXPECT_FALSE (!p))
+            break;
+
+        m.enqueue (p);
+    }
+}
+
+/*
+ * Drain elements from a magazine of the current core into the slabs
+ *
+ * @param m Magazine
+ * @param n Number of elements to drain
+ */
+void Slab_cache::drain (Magazine &m, unsigned n)
+{
+    Lock_guard <Spinlock> guard { lock };
+
+    for (void *p; n-- && (p = m.dequeue()); free_slab (p)) ;
+}
 
 /*
  * Allocate an element in this slab cache
@@ -163,13 +232,72 @@ Slab_cache::Slab_cache (size_t s, size_t a) : bsz (static_cast<uint16_t>(align_u
  */
 void *Slab_cache::alloc()
 {
+    // Allocate from the magazine of the current core
+    if (EXPECT_TRUE (mag < magazines && Cpu::all_online())) {
+
+        auto &m { magazine[mag] };
+
+        if (EXPECT_FALSE (m.empty()))
+            refill (m);
+
+        return m.dequeue();
+    }
+
+    Lock_guard <Spinlock> guard { lock };
+
+    return alloc_slab();
+}
+
+/*
+ * Free an element in this slab cache
+ *
+ * @param p Pointer to the element
+ */
+void Slab_cache::free (void *p)
+{
+    // Ensure we use the correct cache
+    assert (Slab::from_buffer (p)->meta.cache == this);
+
+    // Free into the magazine of the current core
+    if (EXPECT_TRUE (mag < magazines && Cpu::all_online())) {
+
+        auto &m { magazine[mag] };
+
+        if (EXPECT_FALSE (m.full()))
+            drain (m, Magazine::batch);
+
+        m.enqueue (p);
+
+        return;
+    }
+
     Lock_guard <Spinlock> guard { lock };
 
+    free_slab (p);
+}
+
+/*
+ * Allocate an element in a slab of this slab cache
+ *
+ * The caller must hold the slab cache lock.
+ *
+ * @return  Pointer to the element (success) or nullptr (failure)
+ */
+void *Slab_cache::alloc_slab()
+{
     // Cache contains no slabs or only full slabs
     if (EXPECT_FALSE (!curr)) {
 
-        // Allocate a new slab
-        auto const slab { new Slab (this) };
+        Slab *slab;
+
+        // Reuse a retained empty slab or allocate a new slab
+        if (idle) {
+            slab = idle;
+            idle = slab->meta.next;
+            icnt--;
+            Counter::slab_reuse.inc();
+        } else
+            slab = new Slab (this);
 
         // Allocation failed
         if (EXPECT_FALSE (!slab))
@@ -201,14 +329,14 @@ void *Slab_cache::alloc()
 }
 
 /*
- * Free an element in this slab cache
+ * Free an element in a slab of this slab cache
+ *
+ * The caller must hold the slab cache lock.
  *
  * @param p Pointer to the element
  */
-void Slab_cache::free (void *p)
+void Slab_cache::free_slab (void *p)
 {
-    Lock_guard <Spinlock> guard { lock };
-
     // Compute slab for this element
     auto slab = Slab::from_buffer (p);
 
@@ -235,8 +363,14 @@ void Slab_cache::free (void *p)
         if (slab->meta.next)
             slab->meta.next->meta.prev = slab->meta.prev;
 
-        // Deallocate slab
-        delete slab;
+        // Retain slab unless enough are retained or memory is low, otherwise deallocate it
+        if (icnt < rmax && !Buddy::low()) {
+            slab->meta.prev = nullptr;
+            slab->meta.next = idle;
+            idle = slab;
+            icnt++;
+        } else
+            delete slab;
 
     // Slab Transition Full => Partial
     } else if (EXPECT_FALSE (was_full)) {
@@ -22,9 +22,206 @@
 #include "sm.hpp"
 #include "stdio.hpp"
 
-INIT_PRIORITY (PRIO_SLAB) Slab_cache Sm::cache { sizeof (Sm), Kobject::alignment };
+INIT_PRIORITY (PRIO_SLAB) Slab_cache Sm::cache { sizeof (Sm), Kobject::alignment, true };
 
-Sm::Sm (uint64_t c, unsigned i) : Kobject (Kobject::Type::SM), counter (c), id (i)
+Sm::Sm (uint64_t c, unsigned i, Kobject::Subtype s) : Kobject (Kobject::Type::SM, s), counter (c), id (i)
 {
-    trace (TRACE_CREATE, "SM:%p created (CNT:%lu)", static_cast<void *>(this), c);
+    trace (TRACE_CREATE, "SM:%p created (%s:%#lx)", static_cast<void *>(this), s == Kobject::Subtype::SM_NOTIFICATION ? "NTF" : s == Kobject::Subtype::SM_INHERITANCE ? "INH" : "CNT", c);
+}
+
+/*
+ * Bind an interrupt SM to a notification
+ *
+ * The binding holds a reference to the notification.
+ *
+ * @param n     Notification (or nullptr to unbind)
+ * @param b     Bit that the interrupt signals
+ */
+void Sm::bind (Sm *n, unsigned b)
+{
+    bit = b % 64;
+
+    Sm *o { nullptr };
+    target.exchange (o, n);
+
+    if (o)
+        o->release();
+}
+
+/*
+ * Collect an unreferenced SM after an RCU grace period
+ *
+ * ECs that are still blocked on the SM can no longer be woken up by anyone
+ * else, so abort their down operation. A bound interrupt SM also releases
+ * its notification. An EC that is being collected concurrently may still
+ * be cancelling its down operation on the SM (see cancel), so the SM is
+ * destroyed only after another grace period.
+ */
+void Sm::collect()
+{
+    for (Ec *ec;;) {
+
+        {   Lock_guard <Spinlock> guard { lock };
+
+            if (!(ec = dequeue_waiter()))
+                break;
+
+            // The EC can now be activated again
+            ec->unblock (Ec::sys_finish<Status::ABORTED, true>, false);
+        }
+
+        ec->unblock_sc();
+    }
+
+    if (!retired) {
+
+        retired = true;
+
+        own (nullptr);
+
+        bind (nullptr, 0);
+
+        defer();
+
+        return;
+    }
+
+    destroy();
+}
+
+/*
+ * Stop an EC that is being collected from blocking on the SM
+ *
+ * @param ec    Blocked EC
+ */
+void Sm::cancel (Ec *const ec)
+{
+    Lock_guard <Spinlock> guard { lock };
+
+    if (ec->blocker == this) {
+        dequeue (ec);
+        ec->blocker = nullptr;
+    }
+}
+
+/*
+ * Signal a notification
+ *
+ * The bits accumulate in the pending word. If an EC is waiting, it receives
+ * the pending word, which is cleared.
+ *
+ * @param bits  Bits to signal
+ */
+void Sm::signal (uint64_t bits)
+{
+    Ec *ec;
+
+    {   Lock_guard <Spinlock> guard { lock };
+
+        counter |= bits;
+
+        if (!counter || !(ec = dequeue_waiter()))
+            return;
+
+        ec->set_result (counter);
+
+        counter = 0;
+
+        // The EC can now be activated again
+        ec->unblock (Ec::sys_finish<Status::SUCCESS, true>, false);
+    }
+
+    ec->unblock_sc();
+}
+
+/*
+ * Down operation on any of several SMs
+ *
+ * The EC holds a reference to each SM and is linked into the queue of each
+ * SM until the first of them fires or the timeout expires.
+ *
+ * @param self  Calling EC
+ * @param t     Timeout (or 0 if none)
+ */
+void Sm::dn_any (Ec *const self, uint64_t t)
+{
+    self->wait_hit = 0;
+
+    // The EC can no longer be activated
+    self->block();
+
+    for (unsigned i { 0 }; i < self->wait_cnt; i++) {
+
+        auto &w { self->wait[i] };
+
+        Lock_guard <Spinlock> guard { w.sm->lock };
+
+        if (w.sm->counter) {
+
+            // Consume the SM, unless another SM has already fired
+            if (self->hit (static_cast<uint8_t>(i + 1))) {
+                w.sm->counter--;
+                self->unblock (finish_any, true);
+            }
+
+            break;
+        }
+
+        w.sm->any.enqueue_tail (&w);
+    }
+
+    // At this point remote cores can unblock the EC
+
+    if (self->block_sc()) {
+
+        // The timeout holds a reference until the EC resumes
+        if (t && self->wait[0].sm->add_ref())
+            self->set_timeout (t, self->wait[0].sm);
+
+        Scheduler::schedule (true);
+    }
+
+    finish_any (self);
+}
+
+/*
+ * Unlink an EC from all SMs it waits on and drop its references to them
+ *
+ * @param self  Waiting EC
+ */
+void Sm::unwait (Ec *const self)
+{
+    for (; self->wait_cnt; self->wait_cnt--) {
+
+        auto &w { self->wait[self->wait_cnt - 1] };
+
+        {   Lock_guard <Spinlock> guard { w.sm->lock };
+
+            if (w.queued())
+                w.sm->any.dequeue (&w);
+        }
+
+        w.sm->release();
+    }
+}
+
+/*
+ * Resume an EC that waited for any of several SMs
+ *
+ * Upon success, the EC receives the index of the SM that fired.
+ *
+ * @param self  Waiting EC
+ */
+void Sm::finish_any (Ec *const self)
+{
+    auto const h { self->wait_hit.load() };
+
+    unwait (self);
+
+    if (h == Ec::hit_timeout)
+        Ec::sys_finish<Status::TIMEOUT, true> (self);
+
+    self->set_result (h - 1U);
+
+    Ec::sys_finish<Status::SUCCESS, true> (self);
 }
@@ -24,7 +24,7 @@
 #include "space_hst.hpp"
 
 template <typename T>
-Status Space_mem<T>::delegate (Space_hst const *hst, unsigned long const ssb, unsigned long const dsb, unsigned const ord, unsigned const pmm, Memattr ma)
+Status Space_mem<T>::delegate (Space_hst const *hst, unsigned long const ssb, unsigned long const dsb, unsigned const ord, unsigned const pmm, Memattr ma, bool const sync)
 {
     auto const sse { ssb + BITN (ord) }, dse { dsb + BITN (ord) };
 
@@ -61,9 +61,11 @@ Status Space_mem<T>::delegate (Space_hst const *hst, unsigned long const ssb, un
             break;
     }
 
-    static_cast<T *>(this)->sync();
-
-    Buddy::free_wait();
+    // The caller may batch several delegations and synchronize once
+    if (sync) {
+        static_cast<T *>(this)->sync();
+        Buddy::free_wait();
+    }
 
     return sts;
 }
@@ -23,6 +23,7 @@
 #include "space_obj.hpp"
 
 INIT_PRIORITY (PRIO_SPACE_OBJ) ALIGNED (Kobject::alignment) Space_obj Space_obj::nova;
+Space_obj::Cache_entry Space_obj::capcache[cache_entries];
 
 /*
  * The object space consists of a tree of Captables. A Captable has size PAGE_SIZE, is
@@ -53,6 +54,16 @@ INIT_PRIORITY (PRIO_SPACE_OBJ) ALIGNED (Kobject::alignment) Space_obj Space_obj:
  *
  *      Level 3         Level 2             Level 1             Level 0
  *      Captable *      Captable *[n]       Captable *[n]       Capability[n]
+ *
+ * Selectors below selectors_low (e.g. 2^18) do not use the upper levels of the tree.
+ * They are reached via a separate low root that covers lev_low (e.g. 2) levels, so
+ * that their lookups retain the cost of a shallow tree and a space that only uses
+ * low selectors never allocates the upper levels. In the full tree, the subtree
+ * below the all-zero upper indices therefore remains empty.
+ *
+ * Likewise, the last leaf table of selectors, which holds the special selectors
+ * (e.g. NOVA_OBJ), is reached via a separate top root, so that a space with
+ * special selectors does not allocate the full path down to them.
  */
 
 struct Space_obj::Captable
@@ -83,16 +94,24 @@ struct Space_obj::Captable
     }
 
     /*
-     * Deallocate a Captable subtree
+     * Deallocate a Captable subtree and release the objects referenced by its capabilities
      *
      * @param l     Subtree level
      */
     inline void deallocate (unsigned l)
     {
-        if (l)
-            for (unsigned i { 0 }; i < entries; i++)
-                if (slot[i])
-                    slot[i]->deallocate (l - 1);
+        for (unsigned i { 0 }; i < entries; i++) {
+
+            auto const cte { static_cast<Captable *>(slot[i]) };
+
+            if (!cte)
+                continue;
+
+            if (l)
+                cte->deallocate (l - 1);
+            else
+                Capability (reinterpret_cast<uintptr_t>(cte)).obj()->release();
+        }
 
         delete this;
     }
@@ -103,8 +122,14 @@ struct Space_obj::Captable
  */
 Space_obj::~Space_obj()
 {
+    if (low)
+        low->deallocate (lev_low - 1);
+
     if (root)
         root->deallocate (lev - 1);
+
+    if (top)
+        top->deallocate (lev_top - 1);
 }
 
 /*
@@ -116,10 +141,10 @@ Space_obj::~Space_obj()
  */
 Atomic<Capability> *Space_obj::walk (unsigned long sel, bool e)
 {
-    auto l { lev }; Captable *cte;
+    auto l { levels (sel) }; Captable *cte;
 
     // Walk down the capability tables from the root, computing the slot index at each level
-    for (auto ptr { &root };; ptr = &cte->slot[(sel >> --l * bpl) % Captable::entries]) {
+    for (auto ptr { l == lev ? &root : l == lev_low ? &low : &top };; ptr = &cte->slot[(sel >> --l * bpl) % Captable::entries]) {
 
         // Terminate the walk upon reaching the leaf level and return pointer to the capability slot
         if (!l)
@@ -153,6 +178,29 @@ Atomic<Capability> *Space_obj::walk (unsigned long sel, bool e)
     }
 }
 
+/*
+ * Lookup the capability slot for the specified selector without allocating
+ *
+ * @param sel   Selector whose slot is being looked up
+ * @return      Pointer to the capability slot (if exists) or nullptr (otherwise)
+ */
+Atomic<Capability> const *Space_obj::leaf (unsigned long sel) const
+{
+    auto l { levels (sel) }; Captable *cte;
+
+    // Walk down the capability tables from the root, computing the slot index at each level
+    for (auto ptr { l == lev ? &root : l == lev_low ? &low : &top };; ptr = &cte->slot[(sel >> --l * bpl) % Captable::entries]) {
+
+        // Return pointer to the capability slot upon reaching the leaf level
+        if (!l)
+            return reinterpret_cast<Atomic<Capability> const *>(ptr);
+
+        // Terminate the walk if the capability table for the next level does not exist
+        if (!(cte = *ptr))
+            return nullptr;
+    }
+}
+
 /*
  * Lookup OBJ capability for the specified selector
  *
@@ -161,10 +209,10 @@ Atomic<Capability> *Space_obj::walk (unsigned long sel, bool e)
  */
 Capability Space_obj::lookup (unsigned long sel) const
 {
-    auto l { lev }; Captable *cte;
+    auto l { levels (sel) }; Captable *cte;
 
     // Walk down the capability tables from the root, computing the slot index at each level
-    for (auto ptr { &root };; ptr = &cte->slot[(sel >> --l * bpl) % Captable::entries]) {
+    for (auto ptr { l == lev ? &root : l == lev_low ? &low : &top };; ptr = &cte->slot[(sel >> --l * bpl) % Captable::entries]) {
 
         // Return capability upon reaching the last existing or leaf level
         if (!(cte = *ptr) || !l)
@@ -172,12 +220,40 @@ Capability Space_obj::lookup (unsigned long sel) const
     }
 }
 
+/*
+ * Lookup OBJ capability for the specified selector via the capability cache of the current core
+ *
+ * Must only be called once the CPU-local area is accessible (e.g., from system calls).
+ *
+ * @param sel   Selector whose capability is being looked up
+ * @return      Object Capability (if slot is non-empty) or Null Capability (otherwise)
+ */
+Capability Space_obj::lookup_cached (unsigned long sel) const
+{
+    // Read the generation before the capability tables, so that a concurrent update invalidates the entry
+    auto const g { gen.load() };
+
+    auto &e { capcache[(sel ^ reinterpret_cast<uintptr_t>(this) / Kobject::alignment) % cache_entries] };
+
+    if (EXPECT_TRUE (e.gen == g && e.sel == sel))
+        return Capability (e.obj, e.prm);
+
+    auto const cap { lookup (sel) };
+
+    e.gen = g;
+    e.sel = sel;
+    e.obj = cap.obj();
+    e.prm = cap.prm();
+
+    return cap;
+}
+
 /*
  * Update OBJ capability for the specified selector
  *
  * @param sel   Selector whose capability is being updated
  * @param cap   New capability for that selector
- * @param old   Old capability for that selector
+ * @param old   Old capability for that selector (its reference passes to the caller)
  * @return      SUCCESS (successful) or MEM_CAP (allocation failure)
  */
 Status Space_obj::update (unsigned long sel, Capability cap, Capability &old)
@@ -196,12 +272,16 @@ Status Space_obj::update (unsigned long sel, Capability cap, Capability &old)
     // Replace old with new capability
     ptr->exchange (old, cap);
 
+    invalidate();
+
     return Status::SUCCESS;
 }
 
 /*
  * Insert OBJ capability for the specified selector if slot is empty
  *
+ * The capability takes over the reference of the caller (e.g., the creation reference of a new object).
+ *
  * @param sel   Selector whose capability is being inserted
  * @param cap   New capability for that selector (must not be a null capability)
  * @return      SUCCESS (successful) or MEM_CAP (allocation failure) or BAD_CAP (slot not empty)
@@ -216,7 +296,12 @@ Status Space_obj::insert (unsigned long sel, Capability cap)
         return Status::MEM_CAP;
 
     // Try to install the new capability
-    return ptr->compare_exchange (old, cap) ? Status::SUCCESS : Status::BAD_CAP;
+    if (!ptr->compare_exchange (old, cap))
+        return Status::BAD_CAP;
+
+    invalidate();
+
+    return Status::SUCCESS;
 }
 
 /*
@@ -236,19 +321,56 @@ Status Space_obj::delegate (Space_obj const *obj, unsigned long const ssb, unsig
     if (EXPECT_FALSE (sse > selectors || dse > selectors))
         return Status::BAD_PAR;
 
-    auto sts { Status::SUCCESS };
+    // Process the range in runs that stay within one leaf table on both sides
+    for (auto src { ssb }, dst { dsb }; src < sse; ) {
+
+        auto const n { min (sse - src, min (Captable::entries - src % Captable::entries, Captable::entries - dst % Captable::entries)) };
 
-    for (auto src { ssb }, dst { dsb }; src < sse; src++, dst++) {
+        // Walk the source once per run; an unpopulated source table yields null capabilities
+        auto const s { obj->leaf (src) };
 
-        Capability cap { obj->lookup (src) }, old;
+        // Only allocate destination tables if the run delegates at least one capability
+        bool e { false };
 
-        auto const o { cap.obj() };
-        auto const p { cap.prm() & pmm };
+        if (s)
+            for (unsigned long i { 0 }; i < n && !e; i++)
+                e = Capability (s[i]).prm() & pmm;
 
-        // FIXME: Inc refcount for new capability object and dec refcount for old capability object
-        if ((sts = update (dst, Capability (o, p), old)) != Status::SUCCESS)
-            break;
+        // Walk the destination once per run
+        auto const d { walk (dst, e) };
+
+        // Allocation failure
+        if (EXPECT_FALSE (!d)) {
+            invalidate();
+            return Status::MEM_CAP;
+        }
+
+        // Unless both sides are skippable holes, copy/mask the whole run of slots
+        if (d != reinterpret_cast<Atomic<Capability> *>(~0UL)) {
+
+            for (unsigned long i { 0 }; i < n; i++) {
+
+                Capability cap { s ? Capability (s[i]) : Capability() }, old;
+
+                auto const p { cap.prm() & pmm };
+
+                // The new capability holds a reference; an object whose last reference is gone cannot be delegated
+                auto const o { p && cap.obj() && cap.obj()->add_ref() ? cap.obj() : nullptr };
+
+                Capability tmp { o, o ? p : 0 };
+                d[i].exchange (old, tmp);
+
+                // The old capability no longer holds a reference
+                if (old.obj())
+                    old.obj()->release();
+            }
+        }
+
+        src += n;
+        dst += n;
     }
 
-    return sts;
+    invalidate();
+
+    return Status::SUCCESS;
 }
@@ -27,6 +27,7 @@
 #include "interrupt.hpp"
 #include "lowlevel.hpp"
 #include "pt.hpp"
+#include "scg.hpp"
 #include "sm.hpp"
 #include "smmu.hpp"
 #include "space_dma.hpp"
@@ -38,6 +39,7 @@
 #include "stdio.hpp"
 #include "syscall.hpp"
 #include "syscall_tmp.hpp"
+#include "timer.hpp"
 #include "utcb.hpp"
 
 Ec::cont_t const Ec::syscall[16] =
@@ -57,7 +59,7 @@ Ec::cont_t const Ec::syscall[16] =
     &sys_ctrl_hw,
     &sys_assign_int,
     &sys_assign_dev,
-    &sys_finish<Status::BAD_HYP>,
+    &sys_multicall,
 };
 
 void Ec::recv_kern (Ec *const self)
@@ -78,26 +80,86 @@ void Ec::recv_kern (Ec *const self)
     Ec_arch::ret_user_hypercall (self);
 }
 
-void Ec::recv_user (Ec *const self)
+void Ec::recv_remote (Ec *const self)
 {
-    auto ec { self->caller };
+    auto ec { self->caller->client };
 
     assert (ec);
     assert (ec->get_utcb());
-    assert (ec->cont == Ec_arch::ret_user_hypercall);
 
     assert (self);
     assert (self->get_utcb());
     assert (self->subtype == Kobject::Subtype::EC_LOCAL);
-    assert (self->cont == recv_user);
+    assert (self->cont == recv_remote);
 
     auto const mtd { Sys_ipc_reply (self->sys_regs()).mtd_u() };
 
-    ec->get_utcb()->copy (mtd, self->get_utcb());
+    if (Sys_ipc_call (ec->sys_regs()).short_msg())
+        Sys_ipc_short (ec->sys_regs()).copy (self->sys_regs());
+    else {
+        ec->transfer (self, mtd);
+        ec->get_utcb()->copy (mtd, self->get_utcb());
+    }
 
     Ec_arch::ret_user_hypercall (self);
 }
 
+/*
+ * Transfer the typed items of the message into the receive windows of the receiver
+ *
+ * Items that are malformed or do not fit into an open receive window are
+ * skipped. All memory delegations share a single TLB synchronization.
+ *
+ * Must be called before the untyped words are copied, because a long
+ * message overwrites the receive windows in the UTCB of the receiver.
+ *
+ * @param dst   Receiver
+ * @param mtd   Message transfer descriptor
+ */
+void Ec::transfer (Ec *const dst, Mtd_user const mtd) const
+{
+    auto const cnt { mtd.typed() };
+
+    if (EXPECT_TRUE (!cnt))
+        return;
+
+    auto const src { get_utcb() };
+    auto const rcv { dst->get_utcb() };
+
+    bool hst { false };
+
+    for (unsigned i { 0 }; i < cnt && i < Utcb::typed_max; i++) {
+
+        auto const item { src->item (i) };
+        auto const t { item.type() };
+
+        auto const wnd { t == Utcb::Item::Type::HST ? rcv->wnd_hst() : rcv->wnd_obj() };
+
+        if (EXPECT_FALSE ((t != Utcb::Item::Type::HST && t != Utcb::Item::Type::OBJ) || !wnd.open() || item.ord() > wnd.ord()))
+            continue;
+
+        auto const ssb { item.base() };
+
+        // Both the item and the receive window must be naturally aligned
+        if (EXPECT_FALSE (ssb & (BITN (item.ord()) - 1) || wnd.base() & (BITN (wnd.ord()) - 1)))
+            continue;
+
+        // The hotspot selects the location of the item within the receive window
+        auto const dsb { wnd.base() + (item.hot & (BITN (wnd.ord()) - 1) & ~(BITN (item.ord()) - 1)) };
+
+        if (t == Utcb::Item::Type::HST) {
+            dst->get_hst()->delegate (get_hst(), ssb, dsb, item.ord(), item.pmm(), Memattr::ram(), false);
+            hst = true;
+        } else
+            dst->get_obj()->delegate (get_obj(), ssb, dsb, item.ord(), item.pmm());
+    }
+
+    if (hst) {
+        dst->get_hst()->sync();
+        Buddy::free_wait();
+    }
+}
+
 void Ec::rendezvous (Ec *const ec, cont_t c, cont_t e, uintptr_t ip, uintptr_t id, uintptr_t mtd)
 {
     if (EXPECT_FALSE (ec->cont))
@@ -135,16 +197,50 @@ void Ec::reply (cont_t c)
     Scheduler::schedule (true);
 }
 
+/*
+ * Resolve the event portal for the specified event via the event portal cache
+ *
+ * The cache is only accessed on the core of the EC. Any change to the OBJ
+ * space advances its generation, which flushes the cache on the next event.
+ *
+ * @param ep    Event number relative to the event selector base
+ * @return      Pointer to the portal (if valid) or nullptr (otherwise)
+ */
+Pt *Ec::event_portal (unsigned long ep)
+{
+    // Read the generation before the capability tables, so that a concurrent update invalidates the entry
+    auto const g { get_obj()->generation() };
+
+    auto &e { evt_cache[ep % evt_entries] };
+
+    if (EXPECT_TRUE (evt_gen == g && e.pt && e.ep == ep))
+        return e.pt;
+
+    if (evt_gen != g) {
+        for (auto &x : evt_cache)
+            x.pt = nullptr;
+        evt_gen = g;
+    }
+
+    auto cpt { get_obj()->lookup (evt + ep) };
+    if (EXPECT_FALSE (!cpt.validate (Capability::Perm_pt::EVENT)))
+        return nullptr;
+
+    e.ep = ep;
+    e.pt = static_cast<Pt *>(cpt.obj());
+
+    return e.pt;
+}
+
 template <Ec::cont_t C>
 void Ec::send_msg (Ec *const self)
 {
     auto r { self->exc_regs() };
 
-    auto cpt { self->get_obj()->lookup (self->evt + r.ep()) };
-    if (EXPECT_FALSE (!cpt.validate (Capability::Perm_pt::EVENT)))
+    auto pt { self->event_portal (r.ep()) };
+    if (EXPECT_FALSE (!pt))
         self->kill ("PT not found");
 
-    auto pt { static_cast<Pt *>(cpt.obj()) };
     auto ec { pt->ec };
 
     if (EXPECT_FALSE (self->cpu != ec->cpu))
@@ -163,7 +259,7 @@ void Ec::sys_ipc_call (Ec *const self)
 {
     Sys_ipc_call r { self->sys_regs() };
 
-    auto cpt { self->get_obj()->lookup (r.pt()) };
+    auto cpt { self->get_obj()->lookup_cached (r.pt()) };
     if (EXPECT_FALSE (!cpt.validate (Capability::Perm_pt::CALL)))
         sys_finish<Status::BAD_CAP> (self);
 
@@ -171,11 +267,32 @@ void Ec::sys_ipc_call (Ec *const self)
     auto ec { pt->ec };
 
     if (EXPECT_FALSE (self->cpu != ec->cpu))
-        sys_finish<Status::BAD_CPU> (self);
+        self->call_remote (ec->cpu);
 
     assert (ec->subtype == Kobject::Subtype::EC_LOCAL);
 
-    self->rendezvous (ec, Ec_arch::ret_user_hypercall, recv_user, pt->ip, pt->get_id(), r.mtd());
+    // Fast path: the portal EC is idle, so deliver the message and switch to the portal EC directly
+    if (EXPECT_TRUE (!ec->cont)) {
+
+        self->cont = Ec_arch::ret_user_hypercall;
+        self->set_partner (ec);
+
+        if (r.short_msg())
+            Sys_ipc_short (self->sys_regs()).copy (ec->sys_regs());
+        else {
+            self->transfer (ec, r.mtd());
+            self->get_utcb()->copy (r.mtd(), ec->get_utcb());
+        }
+
+        ec->cont = Ec_arch::ret_user_hypercall;
+        ec->exc_regs().ip() = pt->ip;
+
+        Sys_abi abi { ec->sys_regs() };
+        abi.p0() = pt->get_id();
+        abi.p1() = r.mtd();
+
+        static_cast<Ec_arch *>(ec)->make_current();
+    }
 
     if (EXPECT_FALSE (r.timeout()))
         sys_finish<Status::TIMEOUT> (self);
@@ -185,6 +302,124 @@ void Ec::sys_ipc_call (Ec *const self)
     sys_finish<Status::ABORTED> (self);
 }
 
+/*
+ * Call a portal on a remote core
+ *
+ * The caller blocks and a proxy EC on the core of the portal performs the
+ * rendezvous on behalf of the caller and resumes the caller once the call
+ * has been replied to or has failed. Each remote call in progress has its
+ * own proxy EC, so concurrent or nested remote calls do not wait for each
+ * other.
+ *
+ * @param c     Core of the portal
+ */
+void Ec::call_remote (cpu_t c)
+{
+    Status s;
+
+    auto const p { get_proxy (s, c) };
+
+    if (EXPECT_FALSE (!p))
+        sys_finish_status (s);
+
+    // The EC can no longer be activated
+    block();
+
+    // The proxy EC can now be activated
+    p->unblock (serve, false);
+    p->unblock_sc();
+
+    // At this point the remote core can unblock the EC
+
+    if (block_sc())
+        Scheduler::schedule (true);
+
+    static_cast<Ec_arch *>(this)->make_current();
+}
+
+/*
+ * Perform a remote call on behalf of the remote caller of the proxy EC
+ *
+ * The proxy EC validates the portal in the OBJ space of the remote caller
+ * again, because the capability may have changed since the call was made.
+ */
+void Ec::serve (Ec *const self)
+{
+    Sys_ipc_call r { self->client->sys_regs() };
+
+    auto cpt { self->client->get_obj()->lookup_cached (r.pt()) };
+    if (EXPECT_FALSE (!cpt.validate (Capability::Perm_pt::CALL)))
+        finish_remote<sys_finish<Status::BAD_CAP>> (self);
+
+    auto pt { static_cast<Pt *>(cpt.obj()) };
+    auto ec { pt->ec };
+
+    if (EXPECT_FALSE (ec->cpu != Cpu::id))
+        finish_remote<sys_finish<Status::BAD_CPU>> (self);
+
+    assert (ec->subtype == Kobject::Subtype::EC_LOCAL);
+
+    self->rendezvous (ec, finish_remote<Ec_arch::ret_user_hypercall>, recv_remote, pt->ip, pt->get_id(), r.mtd());
+
+    if (EXPECT_FALSE (r.timeout()))
+        finish_remote<sys_finish<Status::TIMEOUT>> (self);
+
+    self->help (ec, serve);
+
+    finish_remote<sys_finish<Status::ABORTED>> (self);
+}
+
+/*
+ * Resume the remote caller with the specified continuation and recycle the proxy EC
+ */
+template <Ec::cont_t C>
+void Ec::finish_remote (Ec *const self)
+{
+    auto const ec { self->client };
+
+    self->client = nullptr;
+
+    Counter::remote.inc();
+
+    trace (TRACE_PERF, "REMOTE: EC:%p CPU:%u->%u %llu ticks", static_cast<void *>(ec), ec->get_cpu(), self->get_cpu(), Timer::time() - self->issued);
+
+    // The EC can now be activated again
+    ec->unblock (C, false);
+    ec->unblock_sc();
+    ec->release();
+
+    recycle (self);
+}
+
+/*
+ * Return the proxy EC to the idle proxy ECs of its core
+ *
+ * Only the SC of the proxy EC blocks on it. Any other SC that runs the
+ * proxy EC (e.g., the SC of a helper) returns to the scheduler instead.
+ * The next remote call starts with a new budget.
+ */
+void Ec::recycle (Ec *const self)
+{
+    auto const sc { self->carrier };
+
+    if (EXPECT_FALSE (Scheduler::get_current() != sc)) {
+        self->cont = recycle;
+        Scheduler::schedule (false);
+    }
+
+    sc->left = 0;
+
+    // The EC can no longer be activated
+    self->block();
+
+    if (EXPECT_TRUE (self->block_sc())) {
+        proxies.enqueue (self);
+        Scheduler::schedule (true);
+    }
+
+    static_cast<Ec_arch *>(self)->make_current();
+}
+
 void Ec::sys_ipc_reply (Ec *const self)
 {
     Sys_ipc_reply r { self->sys_regs() };
@@ -193,9 +428,20 @@ void Ec::sys_ipc_reply (Ec *const self)
 
     if (EXPECT_TRUE (ec)) {
 
-        if (EXPECT_TRUE (ec->cont == Ec_arch::ret_user_hypercall)) {
-            Sys_abi (ec->sys_regs()).p1() = r.mtd_u();
-            self->get_utcb()->copy (r.mtd_u(), ec->get_utcb());
+        // The reply goes to the remote caller on whose behalf the proxy EC called
+        auto const c { ec->client ? ec->client : ec };
+
+        if (EXPECT_TRUE (c->cont == Ec_arch::ret_user_hypercall || ec->client)) {
+
+            Sys_abi (c->sys_regs()).p1() = r.mtd_u();
+
+            // A short reply travels in registers and bypasses the UTCB
+            if (r.short_msg())
+                Sys_ipc_short (self->sys_regs()).copy (c->sys_regs());
+            else {
+                self->transfer (c, r.mtd_u());
+                self->get_utcb()->copy (r.mtd_u(), c->get_utcb());
+            }
         }
 
         else if (EXPECT_FALSE (!static_cast<Ec_arch *>(ec)->state_save (self, r.mtd_a())))
@@ -261,9 +507,53 @@ void Ec::sys_create_sc (Ec *const self)
 {
     Sys_create_sc r { self->sys_regs() };
 
-    trace (TRACE_SYSCALL, "EC:%p %s SEL:%#lx PD:%#lx EC:%#lx P:%u B:%u C:%u", static_cast<void *>(self), __func__, r.sel(), r.pd(), r.ec(), r.prio(), r.budget(), r.cos());
+    trace (TRACE_SYSCALL, "EC:%p %s SEL:%#lx PD:%#lx EC:%#lx P:%u B:%u C:%u M:%u EDF:%u G:%u", static_cast<void *>(self), __func__, r.sel(), r.pd(), r.ec(), r.prio(), r.budget(), r.cos(), r.mig(), r.edf(), r.grp());
+
+    // Group: Quota and period in us (encoded like an EDF budget and period) on a core or global, optionally with a global parent
+    if (r.grp()) {
+
+        auto const b { r.edf_budget() };
+        auto const t { r.edf_period() };
+        auto const c { r.cpu() };
+
+        if (EXPECT_FALSE (!b || b > t || (c != Scg::global && c >= Cpu::count) || (c == Scg::global && r.par())))
+            self->sys_finish_status (Status::BAD_PAR);
+
+        auto const cpd { self->get_obj()->lookup (r.pd()) };
 
-    if (EXPECT_FALSE (!r.prio() || !r.budget() || !Cos::valid_cos (r.cos())))
+        if (EXPECT_FALSE (!cpd.validate (Capability::Perm_pd::SC)))
+            self->sys_finish_status (Status::BAD_CAP);
+
+        Scg *g { nullptr };
+
+        if (r.par()) {
+
+            auto const cpg { self->get_obj()->lookup (r.parent()) };
+
+            if (EXPECT_FALSE (!cpg.validate (Capability::Perm_sc::CTRL, Kobject::Subtype::SC_GROUP)))
+                self->sys_finish_status (Status::BAD_CAP);
+
+            g = static_cast<Scg *>(cpg.obj());
+
+            if (EXPECT_FALSE (g->get_cpu() != Scg::global))
+                self->sys_finish_status (Status::BAD_PAR);
+        }
+
+        Status s;
+        Pd::create_scg (s, self->get_obj(), r.sel(), g, c, b, t);
+
+        self->sys_finish_status (s);
+    }
+
+    if (EXPECT_FALSE (!r.prio() || !Cos::valid_cos (r.cos())))
+        self->sys_finish_status (Status::BAD_PAR);
+
+    // EDF: Budget and relative deadline (defaulting to the period) in us, with budget <= deadline <= period
+    auto const b { r.edf() ? r.edf_budget() : r.budget() * 1000U };
+    auto const t { r.edf() ? r.edf_period() : 0U };
+    auto const d { r.edf() && r.edf_deadline() ? r.edf_deadline() : t };
+
+    if (EXPECT_FALSE (!b || (r.edf() && (b > d || d > t))))
         self->sys_finish_status (Status::BAD_PAR);
 
     auto const cpd { self->get_obj()->lookup (r.pd()) };
@@ -277,8 +567,12 @@ void Ec::sys_create_sc (Ec *const self)
     if (EXPECT_FALSE (ec->subtype == Kobject::Subtype::EC_LOCAL))
         self->sys_finish_status (Status::BAD_CAP);
 
+    // vCPUs have hardware state loaded on their core and cannot migrate
+    if (EXPECT_FALSE (r.mig() && ec->is_vcpu()))
+        self->sys_finish_status (Status::BAD_PAR);
+
     Status s;
-    auto const sc { Pd::create_sc (s, self->get_obj(), r.sel(), ec, ec->cpu, r.budget(), r.prio(), r.cos()) };
+    auto const sc { Pd::create_sc (s, self->get_obj(), r.sel(), ec, b, r.prio(), r.cos(), r.mig(), t, d) };
 
     if (EXPECT_TRUE (sc))
         Scheduler::unblock (sc);
@@ -313,7 +607,10 @@ void Ec::sys_create_sm (Ec *const self)
 {
     Sys_create_sm r { self->sys_regs() };
 
-    trace (TRACE_SYSCALL, "EC:%p %s SEL:%#lx PD:%#lx CNT:%lu", static_cast<void *>(self), __func__, r.sel(), r.pd(), r.cnt());
+    trace (TRACE_SYSCALL, "EC:%p %s SEL:%#lx PD:%#lx CNT:%lu NTF:%u INH:%u", static_cast<void *>(self), __func__, r.sel(), r.pd(), r.cnt(), r.ntf(), r.inh());
+
+    if (EXPECT_FALSE (r.ntf() && r.inh()))
+        self->sys_finish_status (Status::BAD_PAR);
 
     auto const cpd { self->get_obj()->lookup (r.pd()) };
 
@@ -321,7 +618,7 @@ void Ec::sys_create_sm (Ec *const self)
         self->sys_finish_status (Status::BAD_CAP);
 
     Status s;
-    Pd::create_sm (s, self->get_obj(), r.sel(), r.cnt());
+    Pd::create_sm (s, self->get_obj(), r.sel(), r.cnt(), ~0U, r.ntf() ? Kobject::Subtype::SM_NOTIFICATION : r.inh() ? Kobject::Subtype::SM_INHERITANCE : Kobject::Subtype::SM_SEMAPHORE);
 
     self->sys_finish_status (s);
 }
@@ -376,6 +673,7 @@ void Ec::sys_ctrl_ec (Ec *const self)
         self->sys_finish_status (Status::BAD_CAP);
 
     auto const ec { static_cast<Ec *>(cec.obj()) };
+    auto const cpu { ec->get_cpu() };
 
     // Strong: Must wait for observation even if the hazard was set already
     if (r.strong()) {
@@ -383,18 +681,18 @@ void Ec::sys_ctrl_ec (Ec *const self)
         ec->regs.hazard.set (Hazard::RECALL);
 
         // Send IPI only if the EC is remote and current on its core
-        if (Cpu::id != ec->cpu && Ec::remote_current (ec->cpu) == ec) {
+        if (Cpu::id != cpu && Ec::remote_current (cpu) == ec) {
             Cpu::preemption_enable();
-            auto cnt { Counter::req[Interrupt::Request::RKE].get (ec->cpu) };
-            Interrupt::send_cpu (Interrupt::Request::RKE, ec->cpu);
-            while (Counter::req[Interrupt::Request::RKE].get (ec->cpu) == cnt)
+            auto cnt { Counter::req[Interrupt::Request::RKE].get (cpu) };
+            Interrupt::send_cpu (Interrupt::Request::RKE, cpu);
+            while (Counter::req[Interrupt::Request::RKE].get (cpu) == cnt)
                 pause();
             Cpu::preemption_disable();
         }
 
     // Weak: Send IPI only if the hazard was not set already and the EC is remote and current on its core
-    } else if (!ec->regs.hazard.tas (Hazard::RECALL) && Cpu::id != ec->cpu && Ec::remote_current (ec->cpu) == ec)
-        Interrupt::send_cpu (Interrupt::Request::RKE, ec->cpu);
+    } else if (!ec->regs.hazard.tas (Hazard::RECALL) && Cpu::id != cpu && Ec::remote_current (cpu) == ec)
+        Interrupt::send_cpu (Interrupt::Request::RKE, cpu);
 
     self->sys_finish_status (Status::SUCCESS);
 }
@@ -403,15 +701,26 @@ void Ec::sys_ctrl_sc (Ec *const self)
 {
     Sys_ctrl_sc r { self->sys_regs() };
 
-    trace (TRACE_SYSCALL, "EC:%p %s SC:%#lx", static_cast<void *>(self), __func__, r.sc());
+    trace (TRACE_SYSCALL, "EC:%p %s SC:%#lx J:%u", static_cast<void *>(self), __func__, r.sc(), r.join());
 
     auto const csc { self->get_obj()->lookup (r.sc()) };
 
-    if (EXPECT_FALSE (!csc.validate (Capability::Perm_sc::CTRL)))
+    if (EXPECT_FALSE (!csc.validate (Capability::Perm_sc::CTRL, Kobject::Subtype::SC_SCHED)))
         self->sys_finish_status (Status::BAD_CAP);
 
     auto const sc { static_cast<Sc *>(csc.obj()) };
 
+    if (r.join()) {
+
+        auto const cpg { self->get_obj()->lookup (r.grp()) };
+
+        if (EXPECT_FALSE (!cpg.validate (Capability::Perm_sc::CTRL, Kobject::Subtype::SC_GROUP)))
+            self->sys_finish_status (Status::BAD_CAP);
+
+        if (EXPECT_FALSE (!sc->join (static_cast<Scg *>(cpg.obj()))))
+            self->sys_finish_status (Status::BAD_PAR);
+    }
+
     r.set_time_ticks (sc->get_used());
 
     self->sys_finish_status (Status::SUCCESS);
@@ -442,7 +751,49 @@ void Ec::sys_ctrl_sm (Ec *const self)
 
     trace (TRACE_SYSCALL, "EC:%p %s SM:%#lx OP:%u", static_cast<void *>(self), __func__, r.sm(), r.op());
 
-    auto const csm { self->get_obj()->lookup (r.sm()) };
+    // Down on any of several SMs, whose selectors are in the UTCB
+    if (r.any()) {
+
+        // The UTCB of a multicall holds the multicall entries instead
+        if (EXPECT_FALSE (!r.op() || !r.cnt() || r.cnt() > Ec::waiters || self->mc_cnt))
+            self->sys_finish_status (Status::BAD_PAR);
+
+        for (unsigned i { 0 }; i < r.cnt(); i++) {
+
+            auto const csm { self->get_obj()->lookup_cached (self->get_utcb()->sel (i)) };
+
+            if (EXPECT_FALSE (!csm.validate (Capability::Perm_sm::CTRL_DN, Kobject::Subtype::SM_SEMAPHORE) || !csm.obj()->add_ref())) {
+                Sm::unwait (self);
+                self->sys_finish_status (Status::BAD_CAP);
+            }
+
+            auto const sm { static_cast<Sm *>(csm.obj()) };
+
+            auto &w { self->wait[self->wait_cnt++] };
+            w.ec = self;
+            w.sm = sm;
+
+            auto const id { sm->get_id() };
+
+            if (id != ~0U) {
+
+                Interrupt::Config cfg { Interrupt::int_table[id].config };
+
+                if (Cpu::id != cfg.cpu() || sm->is_bound()) {
+                    Sm::unwait (self);
+                    self->sys_finish_status (Cpu::id != cfg.cpu() ? Status::BAD_CPU : Status::BAD_PAR);
+                }
+
+                // Guest-assigned interrupts are deactivated by the guest
+                if (!cfg.gst())
+                    Interrupt::deactivate (id);
+            }
+        }
+
+        Sm::dn_any (self, r.time_ticks());
+    }
+
+    auto const csm { self->get_obj()->lookup_cached (r.sm()) };
 
     if (EXPECT_FALSE (!csm.validate (r.op() ? Capability::Perm_sm::CTRL_DN : Capability::Perm_sm::CTRL_UP)))
         self->sys_finish_status (Status::BAD_CAP);
@@ -463,13 +814,37 @@ void Ec::sys_ctrl_sm (Ec *const self)
             // Guest-assigned interrupts are deactivated by the guest
             if (!cfg.gst())
                 Interrupt::deactivate (id);
+
+            // An interrupt that signals a notification is only acknowledged
+            if (sm->is_bound())
+                self->sys_finish_status (Status::SUCCESS);
+        }
+
+        // The holder runs on the SC of the caller, which retries the down operation once the holder releases the SC
+        if (auto const ec { sm->dn (self, r.zc(), r.time_ticks()) }) {
+
+            self->help (ec, sys_ctrl_sm);
+
+            // The holder is dead
+            sm->dn (self, r.zc(), r.time_ticks(), false);
         }
 
-        sm->dn (self, r.zc(), r.time_ticks());
+    } else if (sm->is_notification())
+        sm->signal (r.bits());
 
-    } else if (!sm->up())   // Up
+    else if (!sm->up())     // Up
         self->sys_finish_status (Status::OVRFLOW);
 
+    // A holder running on a lent SC returns it to the helper
+    else if (sm->is_inheriting() && Scheduler::get_current()->get_ec() != self) {
+
+        self->cont = sys_finish<Status::SUCCESS>;
+
+        Scheduler::get_current()->get_ec()->activate();
+
+        Scheduler::schedule (true);
+    }
+
     self->sys_finish_status (Status::SUCCESS);
 }
 
@@ -530,12 +905,32 @@ void Ec::sys_assign_int (Ec *const self)
     if (EXPECT_FALSE (!csm.validate (Capability::Perm_sm::ASSIGN)))
         self->sys_finish_status (Status::BAD_CAP);
 
-    assert (static_cast<Sm *>(csm.obj())->get_id() != ~0U);
+    auto const sm { static_cast<Sm *>(csm.obj()) };
+
+    assert (sm->get_id() != ~0U);
+
+    // Without a bind or unbind flag, the notification binding of the interrupt remains unchanged
+    if (EXPECT_FALSE (r.bind() && r.unbind()))
+        self->sys_finish_status (Status::BAD_PAR);
+
+    if (r.bind()) {
+
+        auto const cnt { self->get_obj()->lookup (r.ntf()) };
+
+        if (EXPECT_FALSE (!cnt.validate (Capability::Perm_sm::CTRL_UP, Kobject::Subtype::SM_NOTIFICATION) || !cnt.obj()->add_ref()))
+            self->sys_finish_status (Status::BAD_CAP);
+
+        // The interrupt signals the notification instead of its SM
+        sm->bind (static_cast<Sm *>(cnt.obj()), r.bit());
+    }
+
+    else if (r.unbind())
+        sm->bind (nullptr, 0);
 
     uint32_t msi_addr;
     uint16_t msi_data;
 
-    Interrupt::configure (static_cast<Sm *>(csm.obj())->get_id(), Interrupt::Config (r.cpu(), r.dev(), r.flg()), msi_addr, msi_data);
+    Interrupt::configure (sm->get_id(), Interrupt::Config (r.cpu(), r.dev(), r.flg()), msi_addr, msi_data);
 
     r.set_msi_addr (msi_addr);
     r.set_msi_data (msi_data);
@@ -562,15 +957,93 @@ void Ec::sys_assign_dev (Ec *const self)
     if (EXPECT_FALSE (!smmu))
         self->sys_finish_status (Status::BAD_DEV);
 
-    if (EXPECT_FALSE (!smmu->configure (static_cast<Space_dma *>(csp.obj()), r.dad())))
+    auto const dma { static_cast<Space_dma *>(csp.obj()) };
+
+    // The SMMU references the space until the space is destroyed (see Smmu::detach_all)
+    if (EXPECT_FALSE (!smmu->configure (dma, r.dad())))
         self->sys_finish_status (Status::BAD_PAR);
 
     self->sys_finish_status (Status::SUCCESS);
 }
 
+/*
+ * Execute a vector of hypercalls from the UTCB in one kernel entry
+ *
+ * The entries are executed in order until all of them succeeded or one of
+ * them failed. Each entry receives the status and results of its hypercall.
+ * IPC hypercalls and nested multicalls are rejected with BAD_HYP.
+ */
+void Ec::sys_multicall (Ec *const self)
+{
+    Sys_multicall r { self->sys_regs() };
+
+    trace (TRACE_SYSCALL, "EC:%p %s CNT:%lu", static_cast<void *>(self), __func__, r.cnt());
+
+    if (EXPECT_FALSE (!r.cnt() || r.cnt() > Utcb::mc_entries))
+        self->sys_finish_status (Status::BAD_PAR);
+
+    self->mc_idx = 0;
+    self->mc_cnt = static_cast<uint16_t>(r.cnt());
+
+    multicall (self);
+}
+
+/*
+ * Dispatch the current multicall entry
+ */
+void Ec::multicall (Ec *const self)
+{
+    auto const e { self->get_utcb()->mc_entry (self->mc_idx) };
+
+    Sys_abi abi { self->sys_regs() };
+
+    abi.p0() = e[0];
+    abi.p1() = e[1];
+    abi.p2() = e[2];
+    abi.p3() = e[3];
+    abi.p4() = e[4];
+
+    auto const n { e[0] & BIT_RANGE (3, 0) };
+
+    if (EXPECT_FALSE (syscall[n] == sys_ipc_call || syscall[n] == sys_ipc_reply || syscall[n] == sys_multicall))
+        self->sys_finish_status (Status::BAD_HYP);
+
+    (*syscall[n])(self);
+
+    UNREACHED;
+}
+
 void Ec::sys_finish_status (Status s)
 {
-    Sys_abi (sys_regs()).p0() = std::to_underlying (s);
+    Sys_abi abi { sys_regs() };
+
+    abi.p0() = std::to_underlying (s);
+
+    if (EXPECT_FALSE (mc_cnt)) {
+
+        auto const e { get_utcb()->mc_entry (mc_idx++) };
+
+        e[0] = abi.p0();
+        e[1] = abi.p1();
+        e[2] = abi.p2();
+
+        if (EXPECT_TRUE (s == Status::SUCCESS && mc_idx < mc_cnt)) {
+
+            // Restart with the next entry on a fresh kernel stack
+            cont = multicall;
+
+            // Preempt long multicalls between entries
+            Cpu::preemption_point();
+            if (EXPECT_FALSE (Cpu::hazard & Hazard::SCHED))
+                Scheduler::schedule();
+
+            static_cast<Ec_arch *>(this)->make_current();
+        }
+
+        Sys_multicall (sys_regs()).set_done (mc_idx);
+
+        mc_cnt = 0;
+    }
 
     Ec_arch::ret_user_hypercall (this);
 }
@@ -583,3 +1056,11 @@ void Ec::sys_finish (Ec *const self)
 
     self->sys_finish_status (S);
 }
+
+// Resumption of ECs that were blocked on an SM with a timeout or on an SM that was destroyed
+template void Ec::sys_finish<Status::ABORTED, true> (Ec *);
+template void Ec::sys_finish<Status::TIMEOUT, true> (Ec *);
+
+// Resumption of remote callers by the proxy EC, including from Ec::kill
+template void Ec::finish_remote<Ec_arch::ret_user_hypercall> (Ec *);
+template void Ec::finish_remote<Ec::sys_finish<Status::ABORTED>> (Ec *);
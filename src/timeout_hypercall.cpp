@@ -23,3 +23,16 @@ void Timeout_hypercall::trigger()
 {
     sm->timeout (ec);
 }
+
+/*
+ * Cancel the timeout and release the reference it held to the SM
+ */
+void Timeout_hypercall::dequeue()
+{
+    Timeout::dequeue();
+
+    if (sm) {
+        sm->release();
+        sm = nullptr;
+    }
+}
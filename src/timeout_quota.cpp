@@ -0,0 +1,28 @@
+/*
+ * Quota Timeout
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "sc.hpp"
+#include "scg.hpp"
+#include "timeout_quota.hpp"
+
+/*
+ * Make the throttled SCs of a group ready again after its quota has been replenished
+ */
+void Timeout_quota::trigger()
+{
+    for (Sc *sc; (sc = scg->throttled.dequeue_head()); Scheduler::unblock (sc)) ;
+}
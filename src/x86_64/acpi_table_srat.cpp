@@ -0,0 +1,61 @@
+/*
+ * Advanced Configuration and Power Interface (ACPI)
+ *
+ * Copyright (C) 2019-2023 Udo Steinberg, BedRock Systems, Inc.
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "acpi_table_srat.hpp"
+#include "buddy.hpp"
+#include "numa.hpp"
+
+void Acpi_table_srat::Affinity_lapic::parse() const
+{
+    if (flags & Flags::ENABLED)
+        Numa::add_cpu (id, static_cast<uint32_t>(pxm_hi[2]) << 24 | static_cast<uint32_t>(pxm_hi[1]) << 16 | static_cast<uint32_t>(pxm_hi[0]) << 8 | pxm_lo);
+}
+
+void Acpi_table_srat::Affinity_mem::parse() const
+{
+    auto const size { static_cast<uint64_t>(size_hi) << 32 | size_lo };
+
+    if (flags & Flags::ENABLED && size)
+        Numa::add_mem (static_cast<uint64_t>(phys_base_hi) << 32 | phys_base_lo, size, static_cast<uint32_t>(pxm_hi) << 16 | pxm_lo);
+}
+
+void Acpi_table_srat::Affinity_x2apic::parse() const
+{
+    if (flags & Flags::ENABLED)
+        Numa::add_cpu (id, pxm);
+}
+
+void Acpi_table_srat::parse() const
+{
+    auto const addr { reinterpret_cast<uintptr_t>(this) };
+
+    for (auto a { addr + sizeof (*this) }; a < addr + table.header.length; ) {
+
+        auto const c { reinterpret_cast<Affinity const *>(a) };
+
+        switch (c->type) {
+            case Affinity::LAPIC:  static_cast<Affinity_lapic  const *>(c)->parse(); break;
+            case Affinity::MEM:    static_cast<Affinity_mem    const *>(c)->parse(); break;
+            case Affinity::X2APIC: static_cast<Affinity_x2apic const *>(c)->parse(); break;
+            default: break;
+        }
+
+        a += c->length;
+    }
+
+    Buddy::partition();
+}
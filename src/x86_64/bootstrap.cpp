@@ -30,8 +30,10 @@ void bootstrap()
     Cpu::init();
 
     // Before cores leave the barrier into userland, the idle EC must exist
-    if (!Acpi::resume)
+    if (!Acpi::resume) {
         Ec::create_idle();
+        Ec::create_proxy();
+    }
 
     // Barrier: wait for all CPUs to arrive here
     for (Cpu::online++; Cpu::online != Cpu::count; pause()) ;
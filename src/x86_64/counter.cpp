@@ -25,3 +25,6 @@ Counter Counter::req[NUM_IPI];
 Counter Counter::loc[NUM_LVT];
 Counter Counter::schedule;
 Counter Counter::helping;
+Counter Counter::remote;
+Counter Counter::slab_reuse;
+Counter Counter::slab_reclaim;
@@ -31,6 +31,7 @@
 #include "idt.hpp"
 #include "lapic.hpp"
 #include "mca.hpp"
+#include "numa.hpp"
 #include "pconfig.hpp"
 #include "space_hst.hpp"
 #include "stdio.hpp"
@@ -41,7 +42,7 @@
 bool Cpu::bsp;
 cpu_t Cpu::id;
 unsigned Cpu::hazard, Cpu::platform, Cpu::family, Cpu::model, Cpu::stepping, Cpu::patch;
-uint32_t Cpu::features[8], Cpu::topology;
+uint32_t Cpu::features[8], Cpu::topology, Cpu::core_id, Cpu::pkg_id;
 Cpu::Vendor Cpu::vendor;
 Cpu::State_tsc Cpu::hst_tsc;
 
@@ -374,9 +375,13 @@ void Cpu::init()
 
     enumerate_features (clk, rat, lvl, name);
 
+    core_id = lvl[2] << 16 | lvl[1];
+    pkg_id  = lvl[2];
+
     Lapic::init (clk, rat);
 
     if (!Acpi::resume) {
+        Numa::node = Numa::node_by_topology (topology);
         Hpt::OAddr phys; unsigned o; Memattr ma;
         Space_hst::nova.loc[id] = Hptp::current();
         Space_hst::nova.loc[id].lookup (MMAP_CPU_DATA, phys, o, ma);
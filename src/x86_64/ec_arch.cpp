@@ -28,6 +28,8 @@
 #include "rcu.hpp"
 #include "sc.hpp"
 #include "space_gst.hpp"
+#include "space_msr.hpp"
+#include "space_obj.hpp"
 #include "stdio.hpp"
 #include "timer.hpp"
 #include "vpid.hpp"
@@ -36,7 +38,7 @@
 Ec_arch::Ec_arch (cpu_t c, cont_t x) : Ec (&Space_hst::nova, c, x) {}
 
 // Constructor: HST EC
-Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Space_pio *pio, cpu_t c, unsigned long e, uintptr_t sp, uintptr_t hva, void *k) : Ec (t, f, obj, hst, pio, k, c, e, t ? send_msg<ret_user_exception> : nullptr)
+Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Space_pio *pio, cpu_t c, unsigned long e, uintptr_t sp, uintptr_t hva, void *k) : Ec (t, f, obj, hst, pio, k, hva, c, e, t ? send_msg<ret_user_exception> : nullptr)
 {
     assert (obj && hst && pio && k);
 
@@ -56,7 +58,7 @@ Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Space_pio *pio
 }
 
 // Constructor: GST EC (VMX)
-Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Vmcs *v, cpu_t c, unsigned long e, uintptr_t sp, uintptr_t hva, void *k) : Ec (t, f, obj, hst, v, k, c, e, set_vmm_regs_vmx)
+Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Vmcs *v, cpu_t c, unsigned long e, uintptr_t sp, uintptr_t hva, void *k) : Ec (t, f, obj, hst, v, k, hva, c, e, set_vmm_regs_vmx)
 {
     assert (obj && hst && v && k);
 
@@ -97,7 +99,7 @@ Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Vmcs *v, cpu_t
 }
 
 // Constructor: GST EC (SVM)
-Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Vmcb *v, cpu_t c, unsigned long e, uintptr_t /*sp*/) : Ec (t, f, obj, hst, v, nullptr, c, e, send_msg<ret_user_vmexit_svm>)
+Ec_arch::Ec_arch (bool t, Fpu *f, Space_obj *obj, Space_hst *hst, Vmcb *v, cpu_t c, unsigned long e, uintptr_t /*sp*/) : Ec (t, f, obj, hst, v, nullptr, 0, c, e, send_msg<ret_user_vmexit_svm>)
 {
     assert (obj && hst && v);
 
@@ -134,12 +136,13 @@ Ec *Ec::create_gst (Status &s, Pd *pd, bool t, bool fpu, cpu_t cpu, unsigned lon
     auto const obj { pd->get_obj() };
     auto const hst { pd->get_hst() };
 
-    if (EXPECT_FALSE (!obj || !hst)) {
+    if (EXPECT_FALSE (!obj || !hst || !acquire (obj, hst))) {
         s = Status::ABORTED;
         return nullptr;
     }
 
-    // FIXME: Refcount updates
+    // The page tables of the space come from the node of its first EC
+    hst->home (Numa::node_by_cpu (cpu));
 
     auto const f { fpu ? new (pd->fpu_cache) Fpu : nullptr };
     Ec *ec;
@@ -162,11 +165,42 @@ Ec *Ec::create_gst (Status &s, Pd *pd, bool t, bool fpu, cpu_t cpu, unsigned lon
 
     Fpu::operator delete (f, pd->fpu_cache);
 
+    obj->release();
+    hst->release();
+
     s = Status::MEM_OBJ;
 
     return nullptr;
 }
 
+/*
+ * Make the VMCS of a vCPU inactive on its core, so that it can be freed
+ */
+void Ec::unload_vcpu()
+{
+    assert (cpu == Cpu::id);
+
+    if (Hip::feature (Hip_arch::Feature::VMX))
+        regs.vmcs->clear();
+}
+
+/*
+ * Destroy the VMCS/VMCB of a vCPU and release the references it held to its assigned spaces
+ */
+void Ec::destroy_vcpu()
+{
+    if (Hip::feature (Hip_arch::Feature::VMX))
+        delete regs.vmcs;
+    else
+        delete regs.vmcb;
+
+    if (auto const gst { get_gst() })
+        gst->release();
+
+    if (regs.msr)
+        regs.msr->release();
+}
+
 void Ec::adjust_offset_ticks (uint64_t t)
 {
     if (subtype == Kobject::Subtype::EC_VCPU_OFFS) {
@@ -282,6 +316,9 @@ void Ec_arch::ret_user_vmexit_vmx (Ec *const self)
 
     auto const gst { self->get_gst() };
 
+    if (EXPECT_FALSE (Space_gst::stale()))
+        Eptp::invalidate_all();
+
     if (EXPECT_FALSE (gst->gtlb.tst (Cpu::id))) {
         gst->gtlb.clr (Cpu::id);
         gst->invalidate();
@@ -313,6 +350,9 @@ void Ec_arch::ret_user_vmexit_svm (Ec *const self)
 
     auto const gst { self->get_gst() };
 
+    if (EXPECT_FALSE (Space_gst::stale()))
+        self->regs.vmcb->tlb_control = 1;
+
     if (EXPECT_FALSE (gst->gtlb.tst (Cpu::id))) {
         gst->gtlb.clr (Cpu::id);
         self->regs.vmcb->tlb_control = 1;
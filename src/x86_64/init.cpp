@@ -26,6 +26,7 @@
 #include "ioapic.hpp"
 #include "interrupt.hpp"
 #include "kmem.hpp"
+#include "numa.hpp"
 #include "patch.hpp"
 #include "pic.hpp"
 #include "smmu.hpp"
@@ -39,6 +40,9 @@ uintptr_t kern_ptab_setup (apic_t t)
     if (Acpi::resume)
         return Space_hst::nova.loc[Cpu::find_by_topology (t)].root_addr();
 
+    // Allocate the memory of this core from its own node
+    Numa::boot = Numa::node_by_topology (t);
+
     Hptp hptp;
 
     // Share kernel code and data
@@ -94,7 +94,7 @@ void Interrupt::handle_gsi (unsigned gsi)
 
     set_mask (gsi, true);
 
-    int_table[gsi].sm->up();
+    int_table[gsi].sm->trigger();
 }
 
 void Interrupt::handler (unsigned v)
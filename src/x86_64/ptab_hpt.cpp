@@ -25,11 +25,11 @@
 
 INIT_PRIORITY (PRIO_PTAB) Hptp Hptp::master { Kmem::ptr_to_phys (&PTAB_HVAS) };
 
-bool Hptp::share_from (Hptp src, IAddr v, IAddr o)
+bool Hptp::share_from (Hptp src, IAddr v, IAddr o, Numa::node_t n)
 {
     unsigned l = (bit_scan_reverse (v ^ o) - PAGE_BITS) / Hpt::bpl;
 
-    auto d = walk (v, l, true);
+    auto d = walk (v, l, true, n);
     if (!d)
         return false;
 
@@ -116,6 +116,50 @@ bool Smmu::configure (Space_dma *dma, uintptr_t dad, bool inv)
     return true;
 }
 
+/*
+ * Remove all devices from a DMA space that is being destroyed
+ *
+ * SDIDs are reused, so a context entry belongs to the space only if it
+ * also references the page table of the space.
+ *
+ * @param dma   DMA space
+ */
+void Smmu::detach_all (Space_dma *dma)
+{
+    auto const sdid { dma->get_sdid() };
+    bool inv { false };
+
+    {   Lock_guard <Spinlock> guard { cfg_lock };
+
+        for (unsigned b { 0 }; b < 256; b++) {
+
+            auto const r { ctx + b };
+
+            if (!r->present())
+                continue;
+
+            auto const c { static_cast<Entry_ctx *>(Kmem::phys_to_ptr (r->addr())) };
+
+            for (unsigned d { 0 }; d < 256; d++) {
+
+                if (!c[d].present() || c[d].did() != sdid)
+                    continue;
+
+                auto const ptab { dma->get_ptab (c[d].lev() + 1) };
+
+                if (ptab && c[d].addr() == Kmem::ptr_to_phys (ptab)) {
+                    c[d].set (0, 0);
+                    inv = true;
+                }
+            }
+        }
+    }
+
+    if (inv)
+        for (auto l { list }; l; l = l->next)
+            l->invalidate_ctx (sdid);
+}
+
 void Smmu::fault()
 {
     auto const fsts { read (Register32::FSTS) };
@@ -42,10 +42,40 @@ Space_hst::Space_hst() : Space_mem (Kobject::Subtype::HST, nullptr)
     user_access (e, BIT64 (min (Memattr::obits, Hpt::ibits - 1)) - e, true);
 }
 
-void Space_hst::init (unsigned cpu)
+/*
+ * Set up the per-CPU page table of the space for a core
+ *
+ * The page table is allocated from the NUMA node of that core.
+ *
+ * @param cpu   Core (need not be the current core)
+ * @return      True if the page table exists, false on allocation failure
+ */
+bool Space_hst::init (unsigned cpu)
 {
+    auto const n { Numa::node_by_cpu (static_cast<cpu_t>(cpu)) };
+
     if (!cpus.tas (cpu)) {
-        loc[cpu].share_from (nova.loc[cpu], MMAP_CPU, MMAP_SPC);
-        loc[cpu].share_from_master (LINK_ADDR, MMAP_CPU);
+        loc[cpu].share_from (nova.loc[cpu], MMAP_CPU, MMAP_SPC, n);
+        loc[cpu].share_from_master (LINK_ADDR, MMAP_CPU, n);
     }
+
+    return get_ptab (cpu);
+}
+
+/*
+ * Destroy an unreferenced HST space
+ *
+ * @param cache Slab cache of the space
+ */
+void Space_hst::destroy (Slab_cache &cache)
+{
+    // The per-CPU page tables own only their root and the kernel directory; the rest is shared
+    for (cpu_t c { 0 }; c < Cpu::count; c++)
+        loc[c].root_fini (MMAP_SPC, 2);
+
+    hptp.root_fini();
+
+    retained.free();
+
+    operator delete (this, cache);
 }
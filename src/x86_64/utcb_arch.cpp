@@ -707,7 +707,32 @@ bool Utcb_arch::assign_spaces (Cpu_regs &c, Space_obj const *obj) const
     if (EXPECT_FALSE (gst->get_pd() != own || pio->get_pd() != own || msr->get_pd() != own))
         return false;
 
-    // FIXME: Refcount updates
+    // The vCPU holds a reference to each of its spaces, because hardware uses them
+    if (EXPECT_FALSE (!gst->add_ref()))
+        return false;
+
+    if (EXPECT_FALSE (!pio->add_ref())) {
+        gst->release();
+        return false;
+    }
+
+    if (EXPECT_FALSE (!msr->add_ref())) {
+        pio->release();
+        gst->release();
+        return false;
+    }
+
+    if (auto const g { c.gst.load() })
+        g->release();
+
+    if (c.pio)
+        c.pio->release();
+
+    if (c.msr)
+        c.msr->release();
+
+    // The vCPU loads its state on its own core, whose node provides the page tables of the space
+    gst->home (Numa::node);
 
     c.gst = gst;
     c.pio = pio;